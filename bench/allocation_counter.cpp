@@ -0,0 +1,21 @@
+#include "allocation_counter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::size_t allocation_count = 0;
+
+} // namespace
+
+std::size_t allocation_counter::get_allocation_count() { return allocation_count; }
+
+void* operator new(std::size_t size) {
+    ++allocation_count;
+    if (auto ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstddef>
+
+/// Counts calls to the global `operator new` of the benchmark binary, see allocation_counter.cpp.
+namespace allocation_counter {
+
+[[nodiscard]] std::size_t get_allocation_count();
+
+} // namespace allocation_counter
@@ -0,0 +1,40 @@
+#include <benchmark/benchmark.h>
+
+#include "cost_model.hpp"
+#include "plan_shapes.hpp"
+
+namespace {
+
+/// Costs the whole plan from scratch.
+void BM_CostModel_Full(benchmark::State& state) {
+    LQP lqp;
+    plan_shapes::make_bushy(lqp, state.range(0));
+
+    for (auto _ : state) {
+        CostModel cost_model(std::make_unique<CardinalityEstimator>(StatisticsCatalog()));
+        benchmark::DoNotOptimize(cost_model.estimate_cost(lqp, lqp.get_root()));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Recosts the plan after filtering one of its tables, which only affects the path from that table to the root.
+void BM_CostModel_AfterRewrite(benchmark::State& state) {
+    LQP lqp;
+    plan_shapes::make_bushy(lqp, state.range(0));
+    const AbstractLQPNode* table = &lqp.get_root();
+    while (!table->get_input_nodes().empty()) table = &table->get_input_nodes()[0];
+
+    CostModel cost_model(std::make_unique<CardinalityEstimator>(StatisticsCatalog()));
+    benchmark::DoNotOptimize(cost_model.estimate_cost(lqp, lqp.get_root()));
+    for (auto _ : state) {
+        const auto& predicate = lqp.wrap_node_with<PredicateNode>(*table, "t0.x < 10");
+        benchmark::DoNotOptimize(cost_model.estimate_cost(lqp, lqp.get_root()));
+        lqp.bypass_node(predicate);
+        benchmark::DoNotOptimize(cost_model.estimate_cost(lqp, lqp.get_root()));
+    }
+}
+
+} // namespace
+
+BENCHMARK(BM_CostModel_Full)->Arg(100)->Arg(1'000)->Arg(10'000);
+BENCHMARK(BM_CostModel_AfterRewrite)->Arg(100)->Arg(1'000)->Arg(10'000);
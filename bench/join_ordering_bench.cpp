@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "join_ordering.hpp"
+
+namespace {
+
+enum class JoinGraphShape { Chain, Star, Clique };
+
+/// Left-deep join of `relation_count` tables in creation order, with a join predicate per edge of the shape on top.
+void make_join_query(LQP& lqp, std::size_t relation_count, JoinGraphShape shape) {
+    auto table_name = [](std::size_t i) { return "tbl_" + std::to_string(i); };
+
+    std::vector<std::pair<std::size_t, std::size_t>> edges;
+    for (std::size_t i = 1; i < relation_count; ++i) {
+        switch (shape) {
+            case JoinGraphShape::Chain: edges.emplace_back(i - 1, i); break;
+            case JoinGraphShape::Star: edges.emplace_back(0, i); break;
+            case JoinGraphShape::Clique: for (std::size_t j = 0; j < i; ++j) edges.emplace_back(j, i); break;
+        }
+    }
+
+    const AbstractLQPNode* plan = &lqp.make_node<StoredTableNode>(table_name(0));
+    for (std::size_t i = 1; i < relation_count; ++i) {
+        plan = &lqp.make_node<JoinNode>(*plan, lqp.make_node<StoredTableNode>(table_name(i)));
+    }
+    for (const auto& [left, right] : edges) {
+        plan = &lqp.make_node<PredicateNode>(table_name(left) + ".x = " + table_name(right) + ".x", *plan);
+    }
+    lqp.set_root(*plan);
+}
+
+void BM_JoinOrdering_DPccp(benchmark::State& state, JoinGraphShape shape) {
+    LQP lqp;
+    make_join_query(lqp, state.range(0), shape);
+    HeuristicCardinalityEstimator estimator;
+    auto graph = extract_join_graph(lqp, lqp.get_root(), estimator);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(DPccpJoinEnumerator(graph).enumerate());
+    }
+}
+
+void BM_JoinOrdering_Greedy(benchmark::State& state, JoinGraphShape shape) {
+    LQP lqp;
+    make_join_query(lqp, state.range(0), shape);
+    HeuristicCardinalityEstimator estimator;
+    auto graph = extract_join_graph(lqp, lqp.get_root(), estimator);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(GreedyJoinEnumerator(graph).enumerate());
+    }
+    state.SetComplexityN(state.range(0));
+}
+
+void BM_JoinOrdering_Rule(benchmark::State& state, JoinGraphShape shape) {
+    for (auto _ : state) {
+        state.PauseTiming();
+        LQP lqp;
+        make_join_query(lqp, state.range(0), shape);
+        JoinOrderingRule rule;
+        state.ResumeTiming();
+        rule.apply(lqp, 0);
+    }
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_JoinOrdering_DPccp, Chain, JoinGraphShape::Chain)->DenseRange(5, 15, 5);
+BENCHMARK_CAPTURE(BM_JoinOrdering_DPccp, Star, JoinGraphShape::Star)->DenseRange(5, 15, 5);
+BENCHMARK_CAPTURE(BM_JoinOrdering_DPccp, Clique, JoinGraphShape::Clique)->DenseRange(5, 15, 5);
+BENCHMARK_CAPTURE(BM_JoinOrdering_Rule, Chain, JoinGraphShape::Chain)->DenseRange(5, 15, 5);
+BENCHMARK_CAPTURE(BM_JoinOrdering_Rule, Star, JoinGraphShape::Star)->DenseRange(5, 15, 5);
+BENCHMARK_CAPTURE(BM_JoinOrdering_Greedy, Chain, JoinGraphShape::Chain)->RangeMultiplier(2)->Range(16, 128)->Complexity();
+BENCHMARK_CAPTURE(BM_JoinOrdering_Greedy, Star, JoinGraphShape::Star)->RangeMultiplier(2)->Range(16, 128)->Complexity();
+BENCHMARK_CAPTURE(BM_JoinOrdering_Rule, LargeChain, JoinGraphShape::Chain)->Arg(40)->Arg(100);
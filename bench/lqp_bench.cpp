@@ -0,0 +1,221 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+
+#include "allocation_counter.hpp"
+#include "lqp_batch.hpp"
+#include "lqp_copy.hpp"
+#include "lqp_snapshot.hpp"
+#include "plan_shapes.hpp"
+
+namespace {
+
+using PlanBuilder = void (*)(LQP&, std::size_t);
+
+/// Reports nodes per second and heap allocations per node for the operations on `nodes_per_iteration` nodes.
+/// Allocations are counted from construction to destruction, except between `pause` and `resume`.
+class OperationCounters {
+    benchmark::State& state;
+    std::size_t initial_allocations = allocation_counter::get_allocation_count();
+    std::size_t paused_allocations = 0;
+    std::size_t pause_allocations = 0;
+    std::size_t nodes_per_iteration;
+public:
+    OperationCounters(benchmark::State& state, std::size_t nodes_per_iteration)
+            : state(state), nodes_per_iteration(nodes_per_iteration) {}
+
+    /// Pauses timing and allocation counting, for setup or teardown within the benchmark loop.
+    void pause() {
+        state.PauseTiming();
+        pause_allocations = allocation_counter::get_allocation_count();
+    }
+
+    void resume() {
+        paused_allocations += allocation_counter::get_allocation_count() - pause_allocations;
+        state.ResumeTiming();
+    }
+
+    ~OperationCounters() {
+        auto nodes = static_cast<double>(state.iterations() * nodes_per_iteration);
+        auto allocations = static_cast<double>(allocation_counter::get_allocation_count() - initial_allocations
+                                               - paused_allocations);
+        state.counters["nodes/s"] = benchmark::Counter(nodes, benchmark::Counter::kIsRate);
+        state.counters["allocs/node"] = nodes > 0 ? allocations / nodes : 0;
+    }
+};
+
+/// Number of plans built or torn down per iteration of benchmarks that pause in between, so that pausing does not
+/// dominate the time of small plans.
+std::size_t get_plans_per_iteration(std::size_t node_count) {
+    return std::max<std::size_t>(1, 10'000 / node_count);
+}
+
+std::size_t count_nodes(PlanBuilder build, std::size_t node_count) {
+    LQP lqp;
+    build(lqp, node_count);
+    return lqp.get_node_count();
+}
+
+std::vector<const AbstractLQPNode*> collect_tables(const LQP& lqp) {
+    std::vector<const AbstractLQPNode*> tables;
+    lqp.visit<LQP::VisitOrder::PreOrder, LQP::SharedNodes::VisitOnce>(lqp.get_root(), [&](const AbstractLQPNode& node) {
+        if (node.type == LQPNodeType::StoredTable) tables.push_back(&node);
+    });
+    return tables;
+}
+
+/// Discards all output, so that printing is measured without I/O.
+class NullBuffer final : public std::streambuf {
+protected:
+    int_type overflow(int_type c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+/// Builds several plans per iteration into LQPs created beforehand. Creating and destroying the LQPs is excluded.
+void BM_LQP_Build(benchmark::State& state, PlanBuilder build) {
+    std::vector<std::unique_ptr<LQP>> lqps(get_plans_per_iteration(state.range(0)));
+    for (auto& lqp : lqps) lqp = std::make_unique<LQP>();
+    OperationCounters counters(state, count_nodes(build, state.range(0)) * lqps.size());
+    for (auto _ : state) {
+        for (auto& lqp : lqps) build(*lqp, state.range(0));
+        counters.pause();
+        for (auto& lqp : lqps) lqp = std::make_unique<LQP>();
+        counters.resume();
+    }
+}
+
+/// Destroys several plans per iteration, built in between.
+void BM_LQP_Teardown(benchmark::State& state, PlanBuilder build) {
+    std::vector<std::unique_ptr<LQP>> lqps(get_plans_per_iteration(state.range(0)));
+    OperationCounters counters(state, count_nodes(build, state.range(0)) * lqps.size());
+    for (auto _ : state) {
+        counters.pause();
+        for (auto& lqp : lqps) {
+            lqp = std::make_unique<LQP>();
+            build(*lqp, state.range(0));
+        }
+        counters.resume();
+        for (auto& lqp : lqps) lqp.reset();
+    }
+}
+
+void BM_LQP_Visit(benchmark::State& state, PlanBuilder build) {
+    LQP lqp;
+    build(lqp, state.range(0));
+    OperationCounters counters(state, lqp.get_node_count());
+    for (auto _ : state) {
+        auto count = 0;
+        lqp.visit(lqp.get_root(), [&count](const AbstractLQPNode&) { ++count; });
+        benchmark::DoNotOptimize(count);
+    }
+}
+
+void BM_LQP_Print(benchmark::State& state, PlanBuilder build) {
+    LQP lqp;
+    build(lqp, state.range(0));
+    NullBuffer buffer;
+    std::ostream stream(&buffer);
+    OperationCounters counters(state, lqp.get_node_count());
+    for (auto _ : state) {
+        print_lqp(lqp, stream);
+    }
+}
+
+/// Wraps every table with a predicate and bypasses the predicates again, leaving the plan unchanged.
+void BM_LQP_WrapAndBypass(benchmark::State& state, PlanBuilder build) {
+    LQP lqp;
+    build(lqp, state.range(0));
+    auto tables = collect_tables(lqp);
+    std::vector<const PredicateNode*> predicates(tables.size());
+    OperationCounters counters(state, tables.size() * 2);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < tables.size(); ++i) {
+            predicates[i] = &lqp.wrap_node_with<PredicateNode>(*tables[i], "wrapped");
+        }
+        for (auto predicate : predicates) {
+            lqp.bypass_node(*predicate);
+        }
+    }
+}
+
+/// As `BM_LQP_WrapAndBypass`, with the wraps and the bypasses each in one `LQPMutationBatch`.
+void BM_LQP_WrapAndBypassBatched(benchmark::State& state, PlanBuilder build) {
+    LQP lqp;
+    build(lqp, state.range(0));
+    auto tables = collect_tables(lqp);
+    std::vector<const PredicateNode*> predicates(tables.size());
+    OperationCounters counters(state, tables.size() * 2);
+    for (auto _ : state) {
+        LQPMutationBatch wraps(lqp);
+        for (std::size_t i = 0; i < tables.size(); ++i) {
+            predicates[i] = &wraps.wrap_node_with<PredicateNode>(*tables[i], "wrapped");
+        }
+        wraps.commit();
+
+        LQPMutationBatch bypasses(lqp);
+        for (auto predicate : predicates) {
+            bypasses.bypass_node(*predicate);
+        }
+        bypasses.commit();
+    }
+}
+
+/// Copies the plan under the root node by node, see `copy_subplan`.
+void BM_LQP_CopySubplan(benchmark::State& state, PlanBuilder build) {
+    LQP lqp;
+    build(lqp, state.range(0));
+    OperationCounters counters(state, lqp.get_node_count());
+    for (auto _ : state) {
+        LQP copy;
+        copy.set_root(copy_subplan(copy, lqp, lqp.get_root()));
+    }
+}
+
+void BM_LQP_Clone(benchmark::State& state, PlanBuilder build) {
+    LQP lqp;
+    build(lqp, state.range(0));
+    OperationCounters counters(state, lqp.get_node_count());
+    for (auto _ : state) {
+        LQP clone;
+        clone_lqp(clone, lqp);
+    }
+}
+
+/// Publishes a snapshot after every mutation of the plan, which copies it.
+void BM_LQP_PublishSnapshot(benchmark::State& state, PlanBuilder build) {
+    LQP lqp;
+    build(lqp, state.range(0));
+    LQPSnapshotPublisher publisher(lqp);
+    OperationCounters counters(state, lqp.get_node_count());
+    for (auto _ : state) {
+        lqp.set_root(lqp.get_root());
+        benchmark::DoNotOptimize(publisher.publish());
+    }
+}
+
+} // namespace
+
+#define LQP_BENCHMARK_SHAPES(benchmark_function)                                                    \
+    BENCHMARK_CAPTURE(benchmark_function, left_deep, plan_shapes::make_left_deep)                   \
+            ->RangeMultiplier(10)->Range(10, 100'000);                                             \
+    BENCHMARK_CAPTURE(benchmark_function, bushy, plan_shapes::make_bushy)                           \
+            ->RangeMultiplier(10)->Range(10, 100'000);                                             \
+    BENCHMARK_CAPTURE(benchmark_function, star, plan_shapes::make_star)                             \
+            ->RangeMultiplier(10)->Range(10, 100'000);                                             \
+    BENCHMARK_CAPTURE(benchmark_function, predicate_chain, plan_shapes::make_predicate_chain)       \
+            ->RangeMultiplier(10)->Range(10, 100'000);                                             \
+    BENCHMARK_CAPTURE(benchmark_function, diamond, plan_shapes::make_diamond)                       \
+            ->RangeMultiplier(10)->Range(10, 100'000)
+
+LQP_BENCHMARK_SHAPES(BM_LQP_Build);
+LQP_BENCHMARK_SHAPES(BM_LQP_Teardown);
+LQP_BENCHMARK_SHAPES(BM_LQP_Visit);
+LQP_BENCHMARK_SHAPES(BM_LQP_Print);
+LQP_BENCHMARK_SHAPES(BM_LQP_WrapAndBypass);
+LQP_BENCHMARK_SHAPES(BM_LQP_WrapAndBypassBatched);
+LQP_BENCHMARK_SHAPES(BM_LQP_CopySubplan);
+LQP_BENCHMARK_SHAPES(BM_LQP_Clone);
+LQP_BENCHMARK_SHAPES(BM_LQP_PublishSnapshot);
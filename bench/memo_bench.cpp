@@ -0,0 +1,41 @@
+#include <benchmark/benchmark.h>
+
+#include "memo.hpp"
+#include "plan_shapes.hpp"
+#include "transformation_rules.hpp"
+
+namespace {
+
+/// Explores all join orders of a left-deep join of `range(0)` filtered tables, whose number grows exponentially.
+void BM_Memo_ExploreJoins(benchmark::State& state) {
+    LQP lqp;
+    plan_shapes::make_left_deep(lqp, state.range(0) * 3 - 1);
+    auto rules = make_default_transformation_rules();
+
+    for (auto _ : state) {
+        Memo memo;
+        memo.add_plan(lqp, lqp.get_root());
+        memo.explore(rules);
+        state.counters["expressions"] = static_cast<double>(memo.get_expression_count());
+    }
+}
+
+/// Extracts the cheapest plan from an explored memo.
+void BM_Memo_Extract(benchmark::State& state) {
+    LQP lqp;
+    plan_shapes::make_left_deep(lqp, state.range(0) * 3 - 1);
+    Memo memo;
+    auto root = memo.add_plan(lqp, lqp.get_root());
+    memo.explore(make_default_transformation_rules());
+
+    for (auto _ : state) {
+        CostModel cost_model(std::make_unique<CardinalityEstimator>(StatisticsCatalog()));
+        LQP extracted;
+        benchmark::DoNotOptimize(memo.extract(root, cost_model, extracted));
+    }
+}
+
+} // namespace
+
+BENCHMARK(BM_Memo_ExploreJoins)->DenseRange(4, 8, 2)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Memo_Extract)->DenseRange(4, 8, 2)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,51 @@
+#include <benchmark/benchmark.h>
+
+#include "plan_cache.hpp"
+#include "plan_shapes.hpp"
+#include "predicate_pushdown.hpp"
+
+namespace {
+
+Optimizer make_optimizer() {
+    RuleBatch batch{ "Pushdown" };
+    batch.rules.push_back(std::make_unique<PredicatePushdownRule>());
+    Optimizer optimizer;
+    optimizer.add_batch(std::move(batch));
+    return optimizer;
+}
+
+/// Adds a range filter with the given literal on top of a left-deep join of `node_count` nodes.
+void make_query(LQP& lqp, std::size_t node_count, std::size_t literal) {
+    plan_shapes::make_left_deep(lqp, node_count);
+    lqp.set_root(lqp.make_node<PredicateNode>("t0.x < " + std::to_string(literal), lqp.get_root()));
+}
+
+/// Optimizes queries differing only in a literal, all served from the cache after the first one.
+void BM_PlanCache_Hit(benchmark::State& state) {
+    auto optimizer = make_optimizer();
+    PlanCache cache(optimizer);
+    std::size_t literal = 0;
+    for (auto _ : state) {
+        LQP query;
+        make_query(query, state.range(0), literal++);
+        LQP plan;
+        benchmark::DoNotOptimize(cache.optimize(query, plan));
+    }
+}
+
+/// Optimizes the same queries without a cache, for comparison.
+void BM_PlanCache_Uncached(benchmark::State& state) {
+    auto optimizer = make_optimizer();
+    std::size_t literal = 0;
+    for (auto _ : state) {
+        LQP query;
+        make_query(query, state.range(0), literal++);
+        optimizer.optimize(query);
+        benchmark::DoNotOptimize(query.get_root());
+    }
+}
+
+} // namespace
+
+BENCHMARK(BM_PlanCache_Hit)->Arg(10)->Arg(100)->Arg(1'000);
+BENCHMARK(BM_PlanCache_Uncached)->Arg(10)->Arg(100)->Arg(1'000);
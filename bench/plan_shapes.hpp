@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "lqp.hpp"
+#include "lqp_nodes.hpp"
+
+/// Plan builders for benchmarks. Each creates a plan of roughly `node_count` nodes in `lqp` and sets its root.
+namespace plan_shapes {
+
+inline const AbstractLQPNode& make_filtered_table(LQP& lqp, std::size_t i) {
+    auto name = std::to_string(i);
+    return lqp.make_node<PredicateNode>("p" + name, lqp.make_node<StoredTableNode>("t" + name));
+}
+
+/// Joins filtered tables one after another, each join taking the previous one as its left input.
+inline void make_left_deep(LQP& lqp, std::size_t node_count) {
+    const AbstractLQPNode* plan = &make_filtered_table(lqp, 0);
+    for (std::size_t i = 1; lqp.get_node_count() + 3 <= node_count; ++i) {
+        plan = &lqp.make_node<JoinNode>(*plan, make_filtered_table(lqp, i));
+    }
+    lqp.set_root(*plan);
+}
+
+/// Joins filtered tables pairwise, level by level, into a balanced tree.
+inline void make_bushy(LQP& lqp, std::size_t node_count) {
+    std::vector<const AbstractLQPNode*> level;
+    for (std::size_t i = 0; i == 0 || (i + 1) * 3 <= node_count; ++i) level.push_back(&make_filtered_table(lqp, i));
+
+    while (level.size() > 1) {
+        std::vector<const AbstractLQPNode*> next_level;
+        for (std::size_t i = 0; i + 1 < level.size(); i += 2) {
+            next_level.push_back(&lqp.make_node<JoinNode>(*level[i], *level[i + 1]));
+        }
+        if (level.size() % 2 == 1) next_level.push_back(level.back());
+        level = std::move(next_level);
+    }
+    lqp.set_root(*level.front());
+}
+
+/// Snowflake-like wide join graph: a fact table joined with many dimensions, each of which joins a sub-dimension.
+inline void make_star(LQP& lqp, std::size_t node_count) {
+    const AbstractLQPNode* plan = &lqp.make_node<StoredTableNode>("fact");
+    for (std::size_t i = 0; lqp.get_node_count() + 6 <= node_count; ++i) {
+        const auto& dimension = lqp.make_node<JoinNode>(
+                make_filtered_table(lqp, i), lqp.make_node<StoredTableNode>("sub" + std::to_string(i)));
+        plan = &lqp.make_node<JoinNode>(*plan, dimension);
+    }
+    lqp.set_root(*plan);
+}
+
+/// A single table filtered by a long chain of predicates.
+inline void make_predicate_chain(LQP& lqp, std::size_t node_count) {
+    const AbstractLQPNode* plan = &lqp.make_node<StoredTableNode>("t");
+    for (std::size_t i = 1; i < node_count; ++i) plan = &lqp.make_node<PredicateNode>("p" + std::to_string(i), *plan);
+    lqp.set_root(*plan);
+}
+
+/// Chain of joins whose right inputs all share one filtered table, as left by common subplan elimination.
+inline void make_diamond(LQP& lqp, std::size_t node_count) {
+    const auto& shared = make_filtered_table(lqp, 0);
+    const AbstractLQPNode* plan = &lqp.make_node<StoredTableNode>("t");
+    while (lqp.get_node_count() + 2 <= node_count) {
+        plan = &lqp.make_node<JoinNode>(lqp.make_node<PredicateNode>("p", *plan), shared);
+    }
+    lqp.set_root(*plan);
+}
+
+} // namespace plan_shapes
@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "flat_reverse_index.hpp"
+#include "reverse_index.hpp"
+
+namespace {
+
+struct Node {
+    std::uint32_t id;
+    [[nodiscard]] std::uint32_t get_id() const { return id; }
+};
+
+std::vector<Node> make_nodes(std::size_t count) {
+    std::vector<Node> nodes(count);
+    for (std::uint32_t i = 0; i < count; ++i) nodes[i].id = i;
+    return nodes;
+}
+
+/// Links every node to the next one, and every other node additionally to the one after that,
+/// yielding the one-to-two parent fan-in typical for plans.
+template <typename Index>
+void link_nodes(Index& index, const std::vector<Node>& nodes, std::size_t count) {
+    for (std::size_t i = 0; i + 1 < count; ++i) {
+        index.add(nodes[i], nodes[i + 1]);
+        if (i % 2 == 0 && i + 2 < count) index.add(nodes[i], nodes[i + 2]);
+    }
+}
+
+template <typename Index>
+void BM_ReverseIndex_Add(benchmark::State& state) {
+    auto nodes = make_nodes(state.range(0));
+    for (auto _ : state) {
+        Index index;
+        link_nodes(index, nodes, nodes.size());
+        benchmark::DoNotOptimize(index);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Index>
+void BM_ReverseIndex_GetParents(benchmark::State& state) {
+    auto nodes = make_nodes(state.range(0));
+    Index index;
+    link_nodes(index, nodes, nodes.size());
+    for (auto _ : state) {
+        for (const auto& node : nodes) {
+            for (const auto& [_, parent] : index.get_parents(node)) {
+                benchmark::DoNotOptimize(parent);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Mirrors `LQP::wrap_node_with`: a fresh node takes over the parents of an existing one and becomes its parent.
+template <typename Index>
+void BM_ReverseIndex_Wrap(benchmark::State& state) {
+    auto nodes = make_nodes(state.range(0) * 2);
+    for (auto _ : state) {
+        state.PauseTiming();
+        Index index;
+        link_nodes(index, nodes, state.range(0));
+        state.ResumeTiming();
+        for (auto i = state.range(0); i < state.range(0) * 2; ++i) {
+            const auto& node = nodes[i - state.range(0)];
+            const auto& wrapper = nodes[i];
+            index.replace_input(node, wrapper);
+            index.add(node, wrapper);
+        }
+        benchmark::DoNotOptimize(index);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+using MultimapIndex = ReverseDAGIndex<Node>;
+using FlatIndex = FlatReverseDAGIndex<Node>;
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_ReverseIndex_Add, MultimapIndex)->Range(64, 64 << 10);
+BENCHMARK_TEMPLATE(BM_ReverseIndex_Add, FlatIndex)->Range(64, 64 << 10);
+BENCHMARK_TEMPLATE(BM_ReverseIndex_GetParents, MultimapIndex)->Range(64, 64 << 10);
+BENCHMARK_TEMPLATE(BM_ReverseIndex_GetParents, FlatIndex)->Range(64, 64 << 10);
+BENCHMARK_TEMPLATE(BM_ReverseIndex_Wrap, MultimapIndex)->Range(64, 64 << 10);
+BENCHMARK_TEMPLATE(BM_ReverseIndex_Wrap, FlatIndex)->Range(64, 64 << 10);
@@ -0,0 +1,34 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+
+#include "lqp.hpp"
+#include "lqp_nodes.hpp"
+
+namespace {
+
+/// Chain of joins whose right inputs all share one filtered table, as produced by repeated common subexpressions.
+std::unique_ptr<LQP> make_shared_subplan_lqp(std::size_t node_count) {
+    auto lqp = std::make_unique<LQP>();
+    const auto& shared = lqp->make_node<PredicateNode>("shared", lqp->make_node<StoredTableNode>("tbl_shared"));
+    const AbstractLQPNode* plan = &lqp->make_node<StoredTableNode>("tbl");
+    while (lqp->get_node_count() + 2 <= node_count) {
+        plan = &lqp->make_node<JoinNode>(lqp->make_node<PredicateNode>("p", *plan), shared);
+    }
+    lqp->set_root(*plan);
+    return lqp;
+}
+
+void BM_Teardown_SharedSubplans(benchmark::State& state) {
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto lqp = make_shared_subplan_lqp(state.range(0));
+        state.ResumeTiming();
+        lqp.reset();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+BENCHMARK(BM_Teardown_SharedSubplans)->Arg(100)->Arg(1'000)->Arg(10'000);
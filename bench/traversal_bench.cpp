@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "lqp.hpp"
+#include "lqp_nodes.hpp"
+
+namespace {
+
+/// Left-deep join over `table_count` tables, each filtered by a predicate.
+void build_left_deep_plan(LQP& lqp, std::size_t table_count) {
+    const AbstractLQPNode* plan = &lqp.make_node<PredicateNode>("p0", lqp.make_node<StoredTableNode>("t0"));
+    for (std::size_t i = 1; i < table_count; ++i) {
+        auto name = std::to_string(i);
+        const auto& table = lqp.make_node<PredicateNode>("p" + name, lqp.make_node<StoredTableNode>("t" + name));
+        plan = &lqp.make_node<JoinNode>(*plan, table);
+    }
+    lqp.set_root(*plan);
+}
+
+void BM_Traversal_GetInputs(benchmark::State& state) {
+    LQP lqp;
+    build_left_deep_plan(lqp, state.range(0));
+    std::vector<const AbstractLQPNode*> stack;
+    for (auto _ : state) {
+        stack.push_back(&lqp.get_root());
+        while (!stack.empty()) {
+            auto node = stack.back();
+            stack.pop_back();
+            for (auto input : node->get_inputs()) stack.push_back(&input.get());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(lqp.get_node_count()));
+}
+
+void BM_Traversal_GetInputNodes(benchmark::State& state) {
+    LQP lqp;
+    build_left_deep_plan(lqp, state.range(0));
+    std::vector<const AbstractLQPNode*> stack;
+    for (auto _ : state) {
+        stack.push_back(&lqp.get_root());
+        while (!stack.empty()) {
+            auto node = stack.back();
+            stack.pop_back();
+            for (const auto& input : node->get_input_nodes()) stack.push_back(&input);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(lqp.get_node_count()));
+}
+
+} // namespace
+
+BENCHMARK(BM_Traversal_GetInputs)->Range(16, 16 << 10);
+BENCHMARK(BM_Traversal_GetInputNodes)->Range(16, 16 << 10);
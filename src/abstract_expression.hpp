@@ -1,12 +1,82 @@
 #pragma once
 
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "utils.hpp"
+
 enum class ExpressionType {
     Column,
     Constant,
-    Sum
+    /// Placeholder for a constant bound later, see `PlanCache`.
+    Parameter,
+    Function,
+    Sum,
+    Equals,
+    NotEquals,
+    LessThan,
+    LessThanEquals,
+    GreaterThan,
+    GreaterThanEquals,
+    And,
+    Or
 };
 
+/// Expressions are immutable and owned by an `ExpressionPool`, which interns them: within a pool, equal expressions
+/// are the same object, so subexpressions are shared and compared by address.
 class AbstractExpression {
+private:
+    /// Zero until computed, see `get_hash`.
+    mutable std::size_t hash = 0;
+
+protected:
+    explicit AbstractExpression(const ExpressionType type) : type(type) {}
+
 public:
+    virtual ~AbstractExpression() = default;
+
     const ExpressionType type;
+
+    [[nodiscard]] virtual std::span<const AbstractExpression* const> get_arguments() const { return {}; }
+
+    /// Hash of the expression's own attributes, excluding the type and arguments.
+    [[nodiscard]] virtual std::size_t shallow_hash() const = 0;
+
+    /// Compares the expression's own attributes with those of an expression of the same type, ignoring arguments.
+    [[nodiscard]] virtual bool shallow_equals(const AbstractExpression& other) const = 0;
+
+    /// Hash over the type, attributes and arguments of the whole expression, equal for equal expressions of different
+    /// pools. Computed on first use and cached.
+    [[nodiscard]] std::size_t get_hash() const {
+        if (hash != 0) return hash;
+        auto result = static_cast<std::size_t>(type);
+        utils::hash_combine(result, shallow_hash());
+        for (const auto& argument : get_arguments()) utils::hash_combine(result, argument->get_hash());
+        // Zero marks a missing hash.
+        hash = result == 0 ? 1 : result;
+        return hash;
+    }
 };
+
+/// Whether two expressions, possibly of different pools, have equal types, attributes and arguments. Within a pool,
+/// comparing addresses is enough.
+inline bool expressions_equal(const AbstractExpression& lhs, const AbstractExpression& rhs) {
+    std::vector<std::pair<const AbstractExpression*, const AbstractExpression*>> stack{ { &lhs, &rhs } };
+    while (!stack.empty()) {
+        auto [left, right] = stack.back();
+        stack.pop_back();
+        if (left == right) continue;
+        if (left->type != right->type || left->get_hash() != right->get_hash()) return false;
+        if (!left->shallow_equals(*right)) return false;
+
+        auto left_arguments = left->get_arguments();
+        auto right_arguments = right->get_arguments();
+        if (left_arguments.size() != right_arguments.size()) return false;
+        for (std::size_t i = 0; i < left_arguments.size(); ++i) {
+            stack.emplace_back(left_arguments[i], right_arguments[i]);
+        }
+    }
+    return true;
+}
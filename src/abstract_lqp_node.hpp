@@ -1,7 +1,14 @@
 #pragma once
 
-#include <iostream>
+#include <array>
+#include <cstdint>
 #include <functional>
+#include <iostream>
+#include <limits>
+#include <ranges>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "fwd.hpp"
 #include "utils.hpp"
@@ -13,39 +20,95 @@ enum class LQPNodeType {
     Join
 };
 
+using LQPNodeRefCount = utils::ReferenceCount<utils::check_references>;
+
 /// Only allows const access to the node.
 /// Modifications must go through the owner of the node.
-/// Reference counting is only used for consistency checks.
-class LQPNodeRef final : public utils::ReferenceCounter {
+/// Reference counting is only used for consistency checks and compiled out with `LQP_CHECK_REFERENCES=0`.
+class LQPNodeRef final : public utils::BasicReferenceCounter<utils::check_references> {
     std::reference_wrapper<const AbstractLQPNode> node;
 public:
-    explicit LQPNodeRef(const AbstractLQPNode& node, int& ref_count)
-            : utils::ReferenceCounter(ref_count)
+    explicit LQPNodeRef(const AbstractLQPNode& node, LQPNodeRefCount& ref_count)
+            : utils::BasicReferenceCounter<utils::check_references>(ref_count)
             , node(node) {}
 
     [[nodiscard]] const AbstractLQPNode& get_node() const { return node; }
 };
+static_assert(utils::check_references || sizeof(LQPNodeRef) == sizeof(void*));
 
 class LQPNodeRefManager {
 private:
-    mutable int ref_count = 0;
+    [[no_unique_address]] mutable LQPNodeRefCount ref_count{};
     AbstractLQPNode& node;
 protected:
     ~LQPNodeRefManager() {
-        if (ref_count != 0) {
+        if (get_ref_count() != 0) {
             std::cerr << "dangling reference" << std::endl;
             std::terminate();
         }
     }
 public:
     explicit LQPNodeRefManager(AbstractLQPNode& node) : node(node) {}
-    [[nodiscard]] int get_ref_count() const { return ref_count; }
+
+    /// Always zero if reference counting is disabled.
+    [[nodiscard]] int get_ref_count() const { return utils::get_reference_count(ref_count); }
+
     [[nodiscard]] LQPNodeRef get_node_ref() const { return LQPNodeRef(node, ref_count); }
 };
 
 using LQPNodeVector = std::vector<std::reference_wrapper<const AbstractLQPNode>>;
 
+/// Fixed-capacity list of a node's inputs, returned by value without allocating.
+class LQPNodeInputs final {
+public:
+    static constexpr std::size_t max_inputs = 2;
+
+    class iterator final {
+        const AbstractLQPNode* const* input = nullptr;
+    public:
+        using value_type = AbstractLQPNode;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        explicit iterator(const AbstractLQPNode* const* input) : input(input) {}
+
+        const AbstractLQPNode& operator*() const { return **input; }
+        iterator& operator++() { ++input; return *this; }
+        iterator operator++(int) { auto copy = *this; ++input; return copy; }
+        bool operator==(const iterator& other) const { return input == other.input; }
+    };
+
+private:
+    std::array<const AbstractLQPNode*, max_inputs> inputs{};
+    std::size_t count = 0;
+
+public:
+    LQPNodeInputs() = default;
+    explicit LQPNodeInputs(const AbstractLQPNode& input) : inputs{ &input }, count(1) {}
+    LQPNodeInputs(const AbstractLQPNode& left_input, const AbstractLQPNode& right_input)
+            : inputs{ &left_input, &right_input }, count(2) {}
+
+    [[nodiscard]] std::size_t size() const { return count; }
+    [[nodiscard]] bool empty() const { return count == 0; }
+    [[nodiscard]] const AbstractLQPNode& operator[](std::size_t i) const { return *inputs[i]; }
+
+    [[nodiscard]] iterator begin() const { return iterator(inputs.data()); }
+    [[nodiscard]] iterator end() const { return iterator(inputs.data() + count); }
+};
+
 class AbstractLQPNode : public LQPNodeRefManager {
+    friend class LQP;
+
+private:
+    static constexpr std::uint32_t unassigned_id = std::numeric_limits<std::uint32_t>::max();
+
+    /// Assigned by the owning LQP, see `get_id`.
+    std::uint32_t id = unassigned_id;
+
+    /// Zero until computed. Reset by the owning LQP for the node and its ancestors when an input changes,
+    /// so a cached hash implies cached hashes for all inputs.
+    mutable std::size_t structural_hash = 0;
+
 protected:
     explicit AbstractLQPNode(const LQPNodeType type) : LQPNodeRefManager(*this), type(type) {}
 
@@ -54,16 +117,100 @@ public:
 
     const LQPNodeType type;
 
-    [[nodiscard]] virtual LQPNodeVector get_inputs() const = 0;
+    /// Dense id, unique among the live nodes of the owning LQP and smaller than `LQP::get_node_id_bound()`.
+    /// Ids of removed nodes are reused, so side tables keyed by id must not outlive mutations of the plan.
+    [[nodiscard]] std::uint32_t get_id() const { return id; }
+
+    /// Allocation-free access to the inputs, preferred for traversals.
+    [[nodiscard]] virtual LQPNodeInputs get_input_nodes() const = 0;
+
+    /// Convenience wrapper around `get_input_nodes`.
+    [[nodiscard]] LQPNodeVector get_inputs() const {
+        auto inputs = get_input_nodes();
+        return { inputs.begin(), inputs.end() };
+    }
 
     virtual void replace_input(const AbstractLQPNode& old_input, const AbstractLQPNode& new_input) = 0;
+
+    /// Hash of the node's own attributes, excluding the type and inputs.
+    [[nodiscard]] virtual std::size_t shallow_hash() const = 0;
+
+    /// Compares the node's own attributes with those of a node of the same type, ignoring inputs.
+    [[nodiscard]] virtual bool shallow_equals(const AbstractLQPNode& other) const = 0;
+
+    /// Hash over the type, attributes and inputs of the whole subplan. Computed bottom-up on first use and cached.
+    [[nodiscard]] std::size_t get_structural_hash() const;
 };
 
+static_assert(std::ranges::forward_range<LQPNodeInputs>);
+
+inline std::size_t AbstractLQPNode::get_structural_hash() const {
+    if (structural_hash != 0) return structural_hash;
+
+    // Post-order walk over the inputs lacking a cached hash. The flag marks nodes whose inputs are pushed.
+    std::vector<std::pair<const AbstractLQPNode*, bool>> stack{ { this, false } };
+    while (!stack.empty()) {
+        auto [node, inputs_pushed] = stack.back();
+        auto inputs = node->get_input_nodes();
+        if (!inputs_pushed) {
+            stack.back().second = true;
+            for (const auto& input : inputs) {
+                if (input.structural_hash == 0) stack.emplace_back(&input, false);
+            }
+            continue;
+        }
+        stack.pop_back();
+
+        auto hash = static_cast<std::size_t>(node->type);
+        utils::hash_combine(hash, node->shallow_hash());
+        for (const auto& input : inputs) {
+            utils::hash_combine(hash, input.structural_hash);
+        }
+        // Zero marks a missing hash.
+        node->structural_hash = hash == 0 ? 1 : hash;
+    }
+    return structural_hash;
+}
+
+/// Whether two subplans, possibly of different LQPs, consist of equal nodes connected in the same way.
+/// Cached structural hashes reject most mismatches without walking the subplans. Each pair of nodes is compared
+/// once, so shared subplans do not make the comparison exponential in the depth of the plans.
+inline bool structurally_equal(const AbstractLQPNode& lhs, const AbstractLQPNode& rhs) {
+    using NodePair = std::pair<const AbstractLQPNode*, const AbstractLQPNode*>;
+    struct NodePairHash {
+        [[nodiscard]] std::size_t operator()(const NodePair& pair) const {
+            auto hash = std::hash<const AbstractLQPNode*>{}(pair.first);
+            utils::hash_combine(hash, std::hash<const AbstractLQPNode*>{}(pair.second));
+            return hash;
+        }
+    };
+
+    std::vector<NodePair> stack{ { &lhs, &rhs } };
+    std::unordered_set<NodePair, NodePairHash> compared;
+    while (!stack.empty()) {
+        auto [left, right] = stack.back();
+        stack.pop_back();
+        if (left == right) continue;
+        if (!compared.emplace(left, right).second) continue;
+        if (left->type != right->type) return false;
+        if (left->get_structural_hash() != right->get_structural_hash()) return false;
+        if (!left->shallow_equals(*right)) return false;
+
+        auto left_inputs = left->get_input_nodes();
+        auto right_inputs = right->get_input_nodes();
+        if (left_inputs.size() != right_inputs.size()) return false;
+        for (std::size_t i = 0; i < left_inputs.size(); ++i) {
+            stack.emplace_back(&left_inputs[i], &right_inputs[i]);
+        }
+    }
+    return true;
+}
+
 class AbstractLeafNode : public AbstractLQPNode {
 protected:
     explicit AbstractLeafNode(const LQPNodeType& type) : AbstractLQPNode(type) {}
 public:
-    [[nodiscard]] LQPNodeVector get_inputs() const override { return {}; }
+    [[nodiscard]] LQPNodeInputs get_input_nodes() const override { return {}; }
 
     void replace_input(const AbstractLQPNode &old_input, const AbstractLQPNode &new_input) override {
         throw std::logic_error("cannot replace input: node is a leaf");
@@ -80,10 +227,21 @@ protected:
 public:
     [[nodiscard]] std::reference_wrapper<const AbstractLQPNode> get_input() const { return std::ref(input.get_node()); }
 
-    [[nodiscard]] LQPNodeVector get_inputs() const override { return { get_input() }; }
+    [[nodiscard]] LQPNodeInputs get_input_nodes() const override { return LQPNodeInputs(input.get_node()); }
 
     void replace_input(const AbstractLQPNode &old_input, const AbstractLQPNode &new_input) override {
         if (&old_input != &input.get_node()) throw std::logic_error("cannot replace input: input not found");
         input = new_input.get_node_ref();
     }
 };
+
+/// Hash and equality on subplan structure, for keying hash containers on `const AbstractLQPNode*`.
+struct StructuralHash {
+    [[nodiscard]] std::size_t operator()(const AbstractLQPNode* node) const { return node->get_structural_hash(); }
+};
+
+struct StructuralEqual {
+    [[nodiscard]] bool operator()(const AbstractLQPNode* lhs, const AbstractLQPNode* rhs) const {
+        return structurally_equal(*lhs, *rhs);
+    }
+};
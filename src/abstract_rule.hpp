@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+class LQP;
+
+/// Rewrite of an LQP applied by the `Optimizer`.
+/// Rules must be deterministic: once an application left the plan unchanged, applying the rule again to the same plan
+/// must not change it either. This lets the optimizer skip rules whose input did not change since.
+class AbstractRule {
+public:
+    virtual ~AbstractRule() = default;
+
+    [[nodiscard]] virtual std::string_view name() const = 0;
+
+    /// `since_generation` is the LQP generation before the previous application of this rule to the same plan,
+    /// or zero. Subplans for which `LQP::subplan_changed_since(node, since_generation)` is false are unchanged
+    /// since then and may be skipped.
+    virtual void apply(LQP& lqp, std::uint64_t since_generation) = 0;
+};
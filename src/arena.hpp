@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace utils {
+
+/// Bump allocator handing out memory from geometrically growing chunks.
+/// Freed blocks are kept in per-size-class free lists and reused by later allocations of the same class.
+/// Objects are not destroyed by the arena; all memory is released at once when the arena is destroyed.
+class Arena final {
+public:
+    static constexpr std::size_t granularity = alignof(std::max_align_t);
+
+private:
+    static constexpr std::size_t max_chunk_size = 1 << 20;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    std::vector<std::unique_ptr<std::byte[]>> chunks;
+    std::byte* cursor = nullptr;
+    std::byte* chunk_end = nullptr;
+    std::size_t next_chunk_size;
+
+    /// Indexed by size class, i.e. the block size in units of `granularity`, minus one.
+    std::vector<FreeBlock*> free_lists;
+
+    [[nodiscard]] static std::size_t size_class(std::size_t size) {
+        return (std::max(size, sizeof(FreeBlock)) - 1) / granularity;
+    }
+
+    void add_chunk(std::size_t min_size) {
+        auto chunk_size = std::max(next_chunk_size, min_size);
+        chunks.emplace_back(new std::byte[chunk_size]);
+        cursor = chunks.back().get();
+        chunk_end = cursor + chunk_size;
+        next_chunk_size = std::min(next_chunk_size * 2, max_chunk_size);
+    }
+
+public:
+    explicit Arena(std::size_t initial_chunk_size = 4096) : next_chunk_size(initial_chunk_size) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /// Size of the block handed out for an allocation of `size` bytes.
+    [[nodiscard]] static std::size_t get_block_size(std::size_t size) { return (size_class(size) + 1) * granularity; }
+
+    /// Makes the next allocations of blocks totalling `size` bytes, see `get_block_size`, come from a single chunk
+    /// unless they are served from the free lists.
+    void reserve(std::size_t size) {
+        if (static_cast<std::size_t>(chunk_end - cursor) < size) add_chunk(size);
+    }
+
+    /// Returns a block of at least `size` bytes aligned to `granularity`.
+    [[nodiscard]] void* allocate(std::size_t size) {
+        auto cls = size_class(size);
+        if (cls < free_lists.size() && free_lists[cls] != nullptr) {
+            auto block = free_lists[cls];
+            free_lists[cls] = block->next;
+            return block;
+        }
+
+        auto block_size = (cls + 1) * granularity;
+        if (static_cast<std::size_t>(chunk_end - cursor) < block_size) add_chunk(block_size);
+        return std::exchange(cursor, cursor + block_size);
+    }
+
+    /// Returns a block to the free list of its size class. `size` must match the size it was allocated with.
+    void deallocate(void* ptr, std::size_t size) {
+        auto cls = size_class(size);
+        if (cls >= free_lists.size()) free_lists.resize(cls + 1, nullptr);
+        free_lists[cls] = ::new (ptr) FreeBlock{free_lists[cls]};
+    }
+
+    template <typename T, typename... Args>
+    [[nodiscard]] T* create(Args&&... args) {
+        static_assert(alignof(T) <= granularity);
+        auto ptr = allocate(sizeof(T));
+        try {
+            return ::new (ptr) T(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(ptr, sizeof(T));
+            throw;
+        }
+    }
+};
+
+} // namespace utils
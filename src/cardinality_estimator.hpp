@@ -0,0 +1,212 @@
+#pragma once
+
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <variant>
+
+#include "abstract_lqp_node.hpp"
+#include "lqp.hpp"
+#include "lqp_nodes.hpp"
+#include "subplan_cache.hpp"
+#include "table_statistics.hpp"
+
+/// Row count estimates for cost-based rules.
+class AbstractCardinalityEstimator {
+public:
+    virtual ~AbstractCardinalityEstimator() = default;
+
+    /// Estimated number of rows produced by the node of the given LQP.
+    [[nodiscard]] virtual double estimate_cardinality(const LQP& lqp, const AbstractLQPNode& node) = 0;
+
+    /// Estimated fraction of input rows passing the predicate, of a `PredicateNode` or a join condition.
+    [[nodiscard]] virtual double estimate_selectivity(const AbstractExpression& predicate) = 0;
+};
+
+/// Output rows of a join, from the input cardinalities and the selectivity of its condition over their cross
+/// product. Each left row is assumed to have `right * selectivity` matches, at least one of them if that is one or
+/// more.
+[[nodiscard]] inline double estimate_join_cardinality(JoinMode mode, double left, double right, double selectivity) {
+    auto matched_fraction = std::min(right * selectivity, 1.0);
+    switch (mode) {
+        case JoinMode::Inner: return left * right * selectivity;
+        case JoinMode::Left: return std::max(left * right * selectivity, left);
+        case JoinMode::Semi: return left * matched_fraction;
+        case JoinMode::Anti: return left * (1 - matched_fraction);
+    }
+    throw std::logic_error("unknown join mode");
+}
+
+/// Fixed guesses in the style of System R, for use without table statistics.
+///
+/// Like `CardinalityEstimator`, estimates are computed bottom-up without recursion and cached per node in a
+/// `SubplanCache`, so estimating every relation of a join block does not walk their subplans again.
+class HeuristicCardinalityEstimator final : public AbstractCardinalityEstimator {
+private:
+    SubplanCache<double> cache;
+
+    /// Estimate for a node whose inputs are cached.
+    [[nodiscard]] double estimate_uncached(const LQP& lqp, const AbstractLQPNode& node) {
+        auto input_cardinality = [&](std::size_t i) { return *cache.find(lqp, node.get_input_nodes()[i]); };
+        switch (node.type) {
+            case LQPNodeType::StoredTable:
+                return table_cardinality;
+            case LQPNodeType::Predicate:
+                return input_cardinality(0) * estimate_selectivity(static_cast<const PredicateNode&>(node).get_predicate());
+            case LQPNodeType::Join: {
+                const auto& join = static_cast<const JoinNode&>(node);
+                auto selectivity = join.get_condition() ? estimate_selectivity(*join.get_condition()) : 1.0;
+                return estimate_join_cardinality(join.get_mode(), input_cardinality(0), input_cardinality(1), selectivity);
+            }
+            case LQPNodeType::Projection:
+                return input_cardinality(0);
+        }
+        throw std::logic_error("unknown node type");
+    }
+
+public:
+    static constexpr double table_cardinality = 1000;
+    static constexpr double equality_selectivity = 0.1;
+    static constexpr double range_selectivity = 1.0 / 3;
+    static constexpr double default_selectivity = 0.5;
+
+    /// Number of node estimates computed so far, not counting those served from the cache.
+    [[nodiscard]] std::size_t get_estimated_node_count() const { return cache.get_computed_count(); }
+
+    void clear_cache() { cache.clear(); }
+
+    [[nodiscard]] double estimate_cardinality(const LQP& lqp, const AbstractLQPNode& node) override {
+        return cache.get(lqp, node, [&](const AbstractLQPNode& el) { return estimate_uncached(lqp, el); });
+    }
+
+    /// Equality anywhere in the predicate makes it an equality predicate, otherwise a range comparison makes it a
+    /// range predicate.
+    [[nodiscard]] double estimate_selectivity(const AbstractExpression& predicate) override {
+        auto has_equality = false;
+        auto has_range = false;
+        visit_expression(predicate, [&](const AbstractExpression& expression) {
+            has_equality |= expression.type == ExpressionType::Equals;
+            has_range |= is_comparison(expression.type) && expression.type != ExpressionType::Equals
+                         && expression.type != ExpressionType::NotEquals;
+        });
+        if (has_equality) return equality_selectivity;
+        if (has_range) return range_selectivity;
+        return default_selectivity;
+    }
+};
+
+/// Estimates row counts from table statistics, falling back to the guesses of `HeuristicCardinalityEstimator`
+/// where statistics are missing:
+///  - stored tables: the row count of the table,
+///  - predicates: the input cardinality times the selectivity. Equality with a literal selects one distinct value of
+///    the column, range predicates interpolate over the value range of the column, and equality of two columns
+///    selects `1 / max(distinct counts)` of the rows, as for a join on keys,
+///  - joins: the product of the input cardinalities times the selectivity of the join condition, adjusted to the
+///    join mode, see `estimate_join_cardinality`.
+///
+/// Estimates are cached per node in a `SubplanCache`, so after a rewrite only the changed nodes and their ancestors
+/// are estimated again.
+class CardinalityEstimator final : public AbstractCardinalityEstimator {
+private:
+    StatisticsCatalog catalog;
+    SubplanCache<double> cache;
+
+    /// Estimate for a node whose inputs are cached.
+    [[nodiscard]] double estimate_uncached(const LQP& lqp, const AbstractLQPNode& node) {
+        auto input_cardinality = [&](std::size_t i) { return *cache.find(lqp, node.get_input_nodes()[i]); };
+        switch (node.type) {
+            case LQPNodeType::StoredTable: {
+                auto table = catalog.find_table(static_cast<const StoredTableNode&>(node).get_name());
+                return table ? table->row_count : HeuristicCardinalityEstimator::table_cardinality;
+            }
+            case LQPNodeType::Predicate:
+                return input_cardinality(0) * estimate_selectivity(static_cast<const PredicateNode&>(node).get_predicate());
+            case LQPNodeType::Join: {
+                const auto& join = static_cast<const JoinNode&>(node);
+                auto selectivity = join.get_condition() ? estimate_selectivity(*join.get_condition()) : 1.0;
+                return estimate_join_cardinality(join.get_mode(), input_cardinality(0), input_cardinality(1), selectivity);
+            }
+            case LQPNodeType::Projection:
+                return input_cardinality(0);
+        }
+        throw std::logic_error("unknown node type");
+    }
+
+    /// Selectivity of a single comparison such as `tbl_a.x < 10` or `tbl_a.x = tbl_b.y`.
+    [[nodiscard]] double estimate_comparison_selectivity(const BinaryExpression& comparison) const {
+        const auto* left = &comparison.get_left();
+        const auto* right = &comparison.get_right();
+        auto type = comparison.type;
+        if (left->type != ExpressionType::Column && right->type == ExpressionType::Column) {
+            std::swap(left, right);
+            type = mirror_comparison(type);
+        }
+        if (left->type != ExpressionType::Column) return HeuristicCardinalityEstimator::default_selectivity;
+
+        auto find_column = [&](const AbstractExpression& expression) {
+            const auto& column = static_cast<const ColumnExpression&>(expression);
+            return catalog.find_column(column.get_table(), column.get_column());
+        };
+        auto column = find_column(*left);
+        auto is_equality = type == ExpressionType::Equals;
+        auto is_inequality = type == ExpressionType::NotEquals;
+
+        if (right->type == ExpressionType::Column) {
+            if (!is_equality) return HeuristicCardinalityEstimator::range_selectivity;
+            auto right_column = find_column(*right);
+            if (!column && !right_column) return HeuristicCardinalityEstimator::equality_selectivity;
+            auto distinct_count = std::max(column ? column->distinct_count : 1, right_column ? right_column->distinct_count : 1);
+            return 1 / std::max(distinct_count, 1.0);
+        }
+
+        auto equality_selectivity = column ? 1 / std::max(column->distinct_count, 1.0)
+                                           : HeuristicCardinalityEstimator::equality_selectivity;
+        if (is_equality) return equality_selectivity;
+        if (is_inequality) return 1 - equality_selectivity;
+
+        const double* value = nullptr;
+        if (right->type == ExpressionType::Constant) {
+            value = std::get_if<double>(&static_cast<const ConstantExpression&>(*right).get_value());
+        }
+        if (!column || !value || !column->min_value || !column->max_value || *column->max_value <= *column->min_value) {
+            return HeuristicCardinalityEstimator::range_selectivity;
+        }
+        auto fraction_below = std::clamp((*value - *column->min_value) / (*column->max_value - *column->min_value), 0.0, 1.0);
+        auto is_less = type == ExpressionType::LessThan || type == ExpressionType::LessThanEquals;
+        return is_less ? fraction_below : 1 - fraction_below;
+    }
+
+    /// Conjunctions and disjunctions assume independence of their operands.
+    [[nodiscard]] double estimate_expression_selectivity(const AbstractExpression& expression) const {
+        switch (expression.type) {
+            case ExpressionType::And:
+            case ExpressionType::Or: {
+                auto left = estimate_expression_selectivity(*expression.get_arguments()[0]);
+                auto right = estimate_expression_selectivity(*expression.get_arguments()[1]);
+                return expression.type == ExpressionType::And ? left * right : left + right - left * right;
+            }
+            default:
+                if (!is_comparison(expression.type)) return HeuristicCardinalityEstimator::default_selectivity;
+                return estimate_comparison_selectivity(static_cast<const BinaryExpression&>(expression));
+        }
+    }
+
+public:
+    explicit CardinalityEstimator(StatisticsCatalog catalog) : catalog(std::move(catalog)) {}
+
+    [[nodiscard]] const StatisticsCatalog& get_catalog() const { return catalog; }
+
+    /// Number of node estimates computed so far, not counting those served from the cache.
+    [[nodiscard]] std::size_t get_estimated_node_count() const { return cache.get_computed_count(); }
+
+    void clear_cache() { cache.clear(); }
+
+    [[nodiscard]] double estimate_cardinality(const LQP& lqp, const AbstractLQPNode& node) override {
+        return cache.get(lqp, node, [&](const AbstractLQPNode& el) { return estimate_uncached(lqp, el); });
+    }
+
+    [[nodiscard]] double estimate_selectivity(const AbstractExpression& predicate) override {
+        return estimate_expression_selectivity(predicate);
+    }
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "abstract_rule.hpp"
+#include "lqp.hpp"
+#include "lqp_nodes.hpp"
+
+/// Restricts the columns read from stored tables to those the plan uses. Required columns are computed top-down:
+/// the root requires all its columns, a projection requires the columns its expressions reference, a predicate
+/// additionally requires the columns of its predicate, and a join passes the requirements and the columns of its
+/// condition on to both inputs. Shared nodes require the union over their parents.
+///
+/// A projection of the required columns is then inserted above each stored table that is not read by projections
+/// only, and columns no parent requires are removed from existing projections. Only parents reachable from the root
+/// are considered. Tables from which an unqualified column may be required are not pruned, as the column cannot be
+/// attributed to a table, and neither are tables of which no column is required, as an empty projection would not
+/// keep their rows.
+///
+/// Predicates are not pushed through projections, so the rule should run after `PredicatePushdownRule`. Required
+/// columns depend on all ancestors of a node, so the rule always processes the whole plan.
+class ColumnPruningRule final : public AbstractRule {
+private:
+    struct RequiredColumns {
+        /// Set for nodes whose whole output is used, such as the root. `columns` is empty then.
+        bool all = false;
+        /// Columns are interned in the expression pool of the LQP, so they are compared by address.
+        std::unordered_set<const ColumnExpression*> columns;
+
+        void add(const RequiredColumns& other) {
+            if (all) return;
+            if (other.all) {
+                all = true;
+                columns.clear();
+                return;
+            }
+            columns.insert(other.columns.begin(), other.columns.end());
+        }
+
+        void add_referenced(const AbstractExpression& expression) {
+            if (all) return;
+            visit_expression(expression, [&](const AbstractExpression& subexpression) {
+                if (subexpression.type == ExpressionType::Column) {
+                    columns.insert(static_cast<const ColumnExpression*>(&subexpression));
+                }
+            });
+        }
+    };
+
+    /// Replaces the projection by one without the columns that are not required, if there are any and some
+    /// expression is left, as an empty projection would not keep the rows. Returns the projection in place.
+    static const ProjectionNode& narrow_projection(LQP& lqp, const ProjectionNode& projection,
+                                                   const RequiredColumns& required) {
+        if (required.all) return projection;
+        std::vector<const AbstractExpression*> expressions;
+        for (const auto* expression : projection.get_expressions()) {
+            if (expression->type != ExpressionType::Column
+                || required.columns.contains(static_cast<const ColumnExpression*>(expression))) {
+                expressions.push_back(expression);
+            }
+        }
+        if (expressions.empty() || expressions.size() == projection.get_expressions().size()) return projection;
+
+        const auto& narrowed = lqp.make_node<ProjectionNode>(expressions, projection.get_input());
+        lqp.replace_node(projection, narrowed);
+        lqp.remove_node(projection);
+        return narrowed;
+    }
+
+    /// Wraps the table with a projection of its required columns, ordered by name, unless it is read by projections
+    /// only or the columns are not known or empty. `reachable` flags the nodes reachable from the root by id.
+    static void prune_table(LQP& lqp, const StoredTableNode& table, const RequiredColumns& required,
+                            const std::vector<bool>& reachable) {
+        if (required.all) return;
+        auto read_by_projections = true;
+        for (const auto& [_, parent] : lqp.get_parents(table)) {
+            if (!reachable[parent->get_id()]) continue;
+            read_by_projections &= parent->type == LQPNodeType::Projection;
+        }
+        if (read_by_projections) return;
+
+        std::vector<const ColumnExpression*> columns;
+        for (const auto* column : required.columns) {
+            if (column->get_table().empty()) return;
+            if (column->get_table() == table.get_name()) columns.push_back(column);
+        }
+        if (columns.empty()) return;
+        std::ranges::sort(columns, {}, &ColumnExpression::get_column);
+        lqp.wrap_node_with<ProjectionNode>(table, std::vector<const AbstractExpression*>(columns.begin(), columns.end()));
+    }
+
+public:
+    [[nodiscard]] std::string_view name() const override { return "ColumnPruning"; }
+
+    void apply(LQP& lqp, std::uint64_t /* since_generation */) override {
+        // Reversed post-order visits all parents of a node before the node itself.
+        std::vector<const AbstractLQPNode*> nodes;
+        std::vector<bool> reachable(lqp.get_node_id_bound());
+        lqp.visit<LQP::VisitOrder::PostOrder, LQP::SharedNodes::VisitOnce>(lqp.get_root(), [&](const AbstractLQPNode& node) {
+            nodes.push_back(&node);
+            reachable[node.get_id()] = true;
+        });
+
+        std::vector<RequiredColumns> required(lqp.get_node_id_bound());
+        required[lqp.get_root().get_id()].all = true;
+        for (auto node = nodes.rbegin(); node != nodes.rend(); ++node) {
+            const auto& node_required = required[(*node)->get_id()];
+            switch ((*node)->type) {
+                case LQPNodeType::StoredTable:
+                    prune_table(lqp, static_cast<const StoredTableNode&>(**node), node_required, reachable);
+                    break;
+                case LQPNodeType::Predicate: {
+                    const auto& predicate = static_cast<const PredicateNode&>(**node);
+                    auto& input_required = required[predicate.get_input().get().get_id()];
+                    input_required.add(node_required);
+                    input_required.add_referenced(predicate.get_predicate());
+                    break;
+                }
+                case LQPNodeType::Join: {
+                    const auto* condition = static_cast<const JoinNode&>(**node).get_condition();
+                    for (const auto& input : (*node)->get_input_nodes()) {
+                        auto& input_required = required[input.get_id()];
+                        input_required.add(node_required);
+                        if (condition != nullptr) input_required.add_referenced(*condition);
+                    }
+                    break;
+                }
+                case LQPNodeType::Projection: {
+                    const auto& projection = narrow_projection(
+                            lqp, static_cast<const ProjectionNode&>(**node), node_required);
+                    // A narrowed projection is a new node in place of a reachable one.
+                    if (projection.get_id() >= reachable.size()) reachable.resize(projection.get_id() + 1);
+                    reachable[projection.get_id()] = true;
+                    auto& input_required = required[projection.get_input().get().get_id()];
+                    for (const auto* expression : projection.get_expressions()) {
+                        input_required.add_referenced(*expression);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "abstract_rule.hpp"
+#include "lqp.hpp"
+
+/// Merges structurally identical subplans, turning the plan into a DAG in which each distinct subplan occurs once.
+/// Returns the number of removed nodes.
+///
+/// Nodes are processed bottom-up, so the inputs of a node are already merged when the node itself is looked up.
+/// A duplicate therefore shares its inputs with the surviving node, except for duplicates kept side by side as
+/// inputs of one parent. Those are left without parents when the duplicate is removed and are removed with it.
+inline std::size_t eliminate_common_subplans(LQP& lqp) {
+    std::vector<const AbstractLQPNode*> nodes;
+    lqp.visit<LQP::VisitOrder::PostOrder, LQP::SharedNodes::VisitOnce>(lqp.get_root(), [&](const AbstractLQPNode& node) {
+        nodes.push_back(&node);
+    });
+
+    std::unordered_map<const AbstractLQPNode*, const AbstractLQPNode*, StructuralHash, StructuralEqual> subplans;
+    subplans.reserve(nodes.size());
+
+    std::size_t removed_count = 0;
+    for (auto node : nodes) {
+        auto [subplan, inserted] = subplans.emplace(node, node);
+        if (inserted) continue;
+        const auto& survivor = *subplan->second;
+
+        // A parent cannot use the same node for two inputs, so duplicates side by side are kept.
+        auto shares_parent = false;
+        for (const auto& [_, parent] : lqp.get_parents(*node)) {
+            for (const auto& input : parent->get_input_nodes()) shares_parent |= &input == &survivor;
+        }
+        if (shares_parent) continue;
+
+        lqp.replace_node(*node, survivor);
+        std::vector<const AbstractLQPNode*> removable{ node };
+        while (!removable.empty()) {
+            auto el = removable.back();
+            removable.pop_back();
+            if (auto entry = subplans.find(el); entry != subplans.end() && entry->second == el) subplans.erase(entry);
+            auto inputs = el->get_input_nodes();
+            lqp.remove_node(*el);
+            ++removed_count;
+            for (const auto& input : inputs) {
+                if (lqp.get_parent_count(input) == 0) removable.push_back(&input);
+            }
+        }
+    }
+    return removed_count;
+}
+
+class CommonSubplanEliminationRule final : public AbstractRule {
+public:
+    [[nodiscard]] std::string_view name() const override { return "CommonSubplanElimination"; }
+
+    void apply(LQP& lqp, std::uint64_t /* since_generation */) override { eliminate_common_subplans(lqp); }
+};
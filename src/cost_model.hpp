@@ -0,0 +1,84 @@
+#pragma once
+
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "cardinality_estimator.hpp"
+#include "lqp.hpp"
+#include "subplan_cache.hpp"
+
+/// Execution cost of subplans, in abstract units, for cost-based rules to compare alternatives.
+class AbstractCostModel {
+public:
+    virtual ~AbstractCostModel() = default;
+
+    /// Estimated cost of executing the subplan rooted at the node, including all its inputs.
+    [[nodiscard]] virtual double estimate_cost(const LQP& lqp, const AbstractLQPNode& node) = 0;
+
+    /// Estimated cost of the node's operator alone, without its inputs.
+    [[nodiscard]] virtual double estimate_operator_cost(const LQP& lqp, const AbstractLQPNode& node) = 0;
+};
+
+/// Per-row cost terms of `CostModel`.
+struct CostModelParameters {
+    double io_per_row = 1;
+    double cpu_per_row = 0.1;
+    double hash_build_per_row = 0.5;
+    double hash_probe_per_row = 0.2;
+};
+
+/// Default cost model, adding up per-row terms for I/O, CPU work and hash joins:
+///  - stored tables are scanned: `io_per_row` for every row,
+///  - predicates and projections process their input: `cpu_per_row` for every input row,
+///  - joins are hash joins building a hash table on the right input and probing it with the left one:
+///    `hash_build_per_row` and `hash_probe_per_row` for the rows of these inputs, plus `cpu_per_row` for every
+///    output row.
+///
+/// The cost of a subplan is the cost of its root operator plus the costs of its input subplans, so a subplan shared
+/// by several parents is accounted for by each of them. Costs are cached per node in a `SubplanCache`, as are the
+/// cardinalities they are based on, so after a rewrite only the changed nodes and their ancestors are costed again.
+class CostModel final : public AbstractCostModel {
+private:
+    std::unique_ptr<AbstractCardinalityEstimator> estimator;
+    CostModelParameters parameters;
+    SubplanCache<double> cache;
+
+public:
+    explicit CostModel(std::unique_ptr<AbstractCardinalityEstimator> estimator, CostModelParameters parameters = {})
+            : estimator(std::move(estimator))
+            , parameters(parameters) {}
+
+    [[nodiscard]] AbstractCardinalityEstimator& get_estimator() { return *estimator; }
+
+    [[nodiscard]] const CostModelParameters& get_parameters() const { return parameters; }
+
+    /// Number of subplan costs computed so far, not counting those served from the cache.
+    [[nodiscard]] std::size_t get_costed_node_count() const { return cache.get_computed_count(); }
+
+    [[nodiscard]] double estimate_operator_cost(const LQP& lqp, const AbstractLQPNode& node) override {
+        auto cardinality = [&](const AbstractLQPNode& el) { return estimator->estimate_cardinality(lqp, el); };
+        switch (node.type) {
+            case LQPNodeType::StoredTable:
+                return parameters.io_per_row * cardinality(node);
+            case LQPNodeType::Predicate:
+            case LQPNodeType::Projection:
+                return parameters.cpu_per_row * cardinality(node.get_input_nodes()[0]);
+            case LQPNodeType::Join: {
+                auto inputs = node.get_input_nodes();
+                return parameters.hash_probe_per_row * cardinality(inputs[0])
+                       + parameters.hash_build_per_row * cardinality(inputs[1])
+                       + parameters.cpu_per_row * cardinality(node);
+            }
+        }
+        throw std::logic_error("unknown node type");
+    }
+
+    [[nodiscard]] double estimate_cost(const LQP& lqp, const AbstractLQPNode& node) override {
+        return cache.get(lqp, node, [&](const AbstractLQPNode& el) {
+            auto cost = estimate_operator_cost(lqp, el);
+            for (const auto& input : el.get_input_nodes()) cost += *cache.find(lqp, input);
+            return cost;
+        });
+    }
+};
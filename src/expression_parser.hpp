@@ -0,0 +1,185 @@
+#pragma once
+
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "expression_pool.hpp"
+
+/// Recursive descent parser for the SQL-like predicates of `PredicateNode`, in order of increasing precedence:
+///
+///     or         := and ("OR" and)*
+///     and        := comparison ("AND" comparison)*
+///     comparison := sum (("=" | "==" | "!=" | "<>" | "<" | "<=" | ">" | ">=") sum)?
+///     sum        := operand ("+" operand)*
+///     operand    := number | 'string' | $parameter | name ["." name] | name "(" [or ("," or)*] ")" | "(" or ")"
+///
+/// Keywords are case-insensitive. Expressions are created in the given pool. Throws `std::logic_error` on malformed
+/// input.
+class ExpressionParser final {
+private:
+    ExpressionPool& pool;
+    std::string_view text;
+    std::size_t position = 0;
+
+    [[nodiscard]] static bool is_identifier_char(char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    [[noreturn]] void fail(std::string_view message) const {
+        throw std::logic_error("cannot parse expression '" + std::string(text) + "': " + std::string(message) + " at "
+                               + std::to_string(position));
+    }
+
+    void skip_whitespace() {
+        while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position]))) ++position;
+    }
+
+    /// Consumes `token` if the input continues with it. Keywords must not be followed by identifier characters.
+    bool accept(std::string_view token) {
+        skip_whitespace();
+        if (text.size() - position < token.size()) return false;
+        for (std::size_t i = 0; i < token.size(); ++i) {
+            if (std::toupper(static_cast<unsigned char>(text[position + i])) != token[i]) return false;
+        }
+        auto end = position + token.size();
+        if (is_identifier_char(token.back()) && end < text.size() && is_identifier_char(text[end])) return false;
+        position = end;
+        return true;
+    }
+
+    void expect(std::string_view token) {
+        if (!accept(token)) fail("expected '" + std::string(token) + "'");
+    }
+
+    std::string_view parse_name() {
+        skip_whitespace();
+        auto begin = position;
+        while (position < text.size() && is_identifier_char(text[position])) ++position;
+        if (begin == position) fail("expected name");
+        return text.substr(begin, position - begin);
+    }
+
+    const AbstractExpression& parse_or() {
+        const auto* expression = &parse_and();
+        while (accept("OR")) expression = &pool.make<BinaryExpression>(ExpressionType::Or, *expression, parse_and());
+        return *expression;
+    }
+
+    const AbstractExpression& parse_and() {
+        const auto* expression = &parse_comparison();
+        while (accept("AND")) {
+            expression = &pool.make<BinaryExpression>(ExpressionType::And, *expression, parse_comparison());
+        }
+        return *expression;
+    }
+
+    const AbstractExpression& parse_comparison() {
+        const auto* expression = &parse_sum();
+        // Longer operators first, so that `<=` is not taken for `<`.
+        constexpr std::pair<std::string_view, ExpressionType> operators[] = {
+            { "==", ExpressionType::Equals },         { "!=", ExpressionType::NotEquals },
+            { "<>", ExpressionType::NotEquals },      { "<=", ExpressionType::LessThanEquals },
+            { ">=", ExpressionType::GreaterThanEquals }, { "=", ExpressionType::Equals },
+            { "<", ExpressionType::LessThan },        { ">", ExpressionType::GreaterThan },
+        };
+        for (const auto& [symbol, type] : operators) {
+            if (accept(symbol)) return pool.make<BinaryExpression>(type, *expression, parse_sum());
+        }
+        return *expression;
+    }
+
+    const AbstractExpression& parse_sum() {
+        const auto* expression = &parse_operand();
+        while (accept("+")) expression = &pool.make<BinaryExpression>(ExpressionType::Sum, *expression, parse_operand());
+        return *expression;
+    }
+
+    const AbstractExpression& parse_operand() {
+        skip_whitespace();
+        if (position == text.size()) fail("expected operand");
+        auto c = text[position];
+
+        if (accept("(")) {
+            const auto* expression = &parse_or();
+            expect(")");
+            return *expression;
+        }
+        if (c == '\'') {
+            auto closing_quote = text.find('\'', position + 1);
+            if (closing_quote == std::string_view::npos) fail("unterminated string");
+            std::string value(text.substr(position + 1, closing_quote - position - 1));
+            position = closing_quote + 1;
+            return pool.make<ConstantExpression>(std::move(value));
+        }
+        if (c == '$') {
+            ++position;
+            std::size_t index = 0;
+            auto [end, error] = std::from_chars(text.data() + position, text.data() + text.size(), index);
+            if (error != std::errc()) fail("expected parameter index");
+            position = static_cast<std::size_t>(end - text.data());
+            return pool.make<ParameterExpression>(index);
+        }
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '-' || c == '.') {
+            double value = 0;
+            auto [end, error] = std::from_chars(text.data() + position, text.data() + text.size(), value);
+            if (error != std::errc()) fail("expected number");
+            position = static_cast<std::size_t>(end - text.data());
+            return pool.make<ConstantExpression>(value);
+        }
+
+        auto name = parse_name();
+        if (accept("(")) {
+            std::vector<const AbstractExpression*> arguments;
+            if (!accept(")")) {
+                do {
+                    arguments.push_back(&parse_or());
+                } while (accept(","));
+                expect(")");
+            }
+            return pool.make<FunctionExpression>(std::string(name), std::move(arguments));
+        }
+        if (position < text.size() && text[position] == '.') {
+            ++position;
+            return pool.make<ColumnExpression>(std::string(name), std::string(parse_name()));
+        }
+        return pool.make<ColumnExpression>("", std::string(name));
+    }
+
+public:
+    ExpressionParser(ExpressionPool& pool, std::string_view text) : pool(pool), text(text) {}
+
+    [[nodiscard]] const AbstractExpression& parse() {
+        position = 0;
+        const auto* expression = &parse_or();
+        skip_whitespace();
+        if (position != text.size()) fail("unexpected input");
+        return *expression;
+    }
+
+    /// Parses a comma-separated, possibly empty list of expressions.
+    [[nodiscard]] std::vector<const AbstractExpression*> parse_list() {
+        position = 0;
+        std::vector<const AbstractExpression*> expressions;
+        skip_whitespace();
+        if (position == text.size()) return expressions;
+        do {
+            expressions.push_back(&parse_or());
+        } while (accept(","));
+        skip_whitespace();
+        if (position != text.size()) fail("unexpected input");
+        return expressions;
+    }
+};
+
+[[nodiscard]] inline const AbstractExpression& parse_expression(ExpressionPool& pool, std::string_view text) {
+    return ExpressionParser(pool, text).parse();
+}
+
+[[nodiscard]] inline std::vector<const AbstractExpression*> parse_expression_list(ExpressionPool& pool,
+                                                                                 std::string_view text) {
+    return ExpressionParser(pool, text).parse_list();
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "arena.hpp"
+#include "expressions.hpp"
+
+/// Owns the expressions of an LQP and interns them (hash-consing): creating an expression equal to an existing one
+/// returns the existing one. As arguments are interned before their parents, an expression is looked up by its own
+/// attributes and the addresses of its arguments, in constant time, and equal expressions of a pool are the same
+/// object. Expressions are allocated from an arena and live as long as the pool.
+class ExpressionPool final {
+private:
+    struct ExpressionHash {
+        [[nodiscard]] std::size_t operator()(const AbstractExpression* expression) const {
+            return expression->get_hash();
+        }
+    };
+
+    struct ExpressionEqual {
+        [[nodiscard]] bool operator()(const AbstractExpression* lhs, const AbstractExpression* rhs) const {
+            if (lhs->type != rhs->type || lhs->get_hash() != rhs->get_hash()) return false;
+            auto lhs_arguments = lhs->get_arguments();
+            auto rhs_arguments = rhs->get_arguments();
+            if (!std::ranges::equal(lhs_arguments, rhs_arguments)) return false;
+            return lhs->shallow_equals(*rhs);
+        }
+    };
+
+    utils::Arena arena;
+    std::unordered_set<const AbstractExpression*, ExpressionHash, ExpressionEqual> expressions;
+
+    /// Interns an expression of the type and attributes of `expression`, with the given arguments of this pool.
+    const AbstractExpression& make_with_arguments(const AbstractExpression& expression,
+                                                  std::span<const AbstractExpression* const> arguments) {
+        switch (expression.type) {
+            case ExpressionType::Column: {
+                const auto& column = static_cast<const ColumnExpression&>(expression);
+                return make<ColumnExpression>(column.get_table(), column.get_column());
+            }
+            case ExpressionType::Constant:
+                return make<ConstantExpression>(static_cast<const ConstantExpression&>(expression).get_value());
+            case ExpressionType::Parameter:
+                return make<ParameterExpression>(static_cast<const ParameterExpression&>(expression).get_index());
+            case ExpressionType::Function:
+                return make<FunctionExpression>(static_cast<const FunctionExpression&>(expression).get_name(),
+                                                std::vector<const AbstractExpression*>(arguments.begin(), arguments.end()));
+            default:
+                return make<BinaryExpression>(expression.type, *arguments[0], *arguments[1]);
+        }
+    }
+
+public:
+    ExpressionPool() = default;
+    ExpressionPool(const ExpressionPool&) = delete;
+    ExpressionPool& operator=(const ExpressionPool&) = delete;
+
+    ~ExpressionPool() {
+        for (const auto* expression : expressions) std::destroy_at(const_cast<AbstractExpression*>(expression));
+    }
+
+    /// Returns the expression `T(args...)` of this pool, creating it if it does not exist yet. Arguments of the
+    /// expression must belong to this pool.
+    template <typename T, typename... Args>
+    [[nodiscard]] const T& make(Args&&... args) {
+        static_assert(std::derived_from<T, AbstractExpression>);
+        auto expression = arena.create<T>(std::forward<Args>(args)...);
+        auto discard = [&] {
+            std::destroy_at(expression);
+            arena.deallocate(expression, sizeof(T));
+        };
+        for (const auto* argument : expression->get_arguments()) {
+            if (!contains(*argument)) {
+                discard();
+                throw std::logic_error("cannot make expression: argument of another pool");
+            }
+        }
+
+        auto [existing, inserted] = expressions.insert(expression);
+        if (!inserted) discard();
+        return static_cast<const T&>(**existing);
+    }
+
+    /// Whether the expression itself, not just an equal one, belongs to this pool.
+    [[nodiscard]] bool contains(const AbstractExpression& expression) const {
+        auto existing = expressions.find(&expression);
+        return existing != expressions.end() && *existing == &expression;
+    }
+
+    /// Copy of `expression` in this pool in which every subexpression for which `replace_with` returns an expression,
+    /// rather than null, is replaced by it. Subexpressions are visited in pre-order, left to right. `expression`
+    /// and the replacements may belong to any pool.
+    template <typename Replace>
+    [[nodiscard]] const AbstractExpression& replace(const AbstractExpression& expression, Replace&& replace_with) {
+        if (const AbstractExpression* replacement = replace_with(expression)) return import(*replacement);
+
+        auto arguments = expression.get_arguments();
+        std::vector<const AbstractExpression*> new_arguments;
+        new_arguments.reserve(arguments.size());
+        for (const auto* argument : arguments) new_arguments.push_back(&replace(*argument, replace_with));
+        if (std::ranges::equal(arguments, new_arguments) && contains(expression)) return expression;
+        return make_with_arguments(expression, new_arguments);
+    }
+
+    /// The expression of this pool equal to `expression`, which may belong to any pool. Constant time for
+    /// expressions of this pool.
+    [[nodiscard]] const AbstractExpression& import(const AbstractExpression& expression) {
+        if (contains(expression)) return expression;
+        std::vector<const AbstractExpression*> arguments;
+        for (const auto* argument : expression.get_arguments()) arguments.push_back(&import(*argument));
+        return make_with_arguments(expression, arguments);
+    }
+
+    [[nodiscard]] std::size_t size() const { return expressions.size(); }
+};
+
+/// Conjunction of the expressions, left-associative and in order, such as `(a AND b) AND c`. Null if there are none.
+[[nodiscard]] inline const AbstractExpression* make_conjunction(ExpressionPool& pool,
+                                                                std::span<const AbstractExpression* const> expressions) {
+    const AbstractExpression* conjunction = nullptr;
+    for (const auto* expression : expressions) {
+        conjunction = conjunction == nullptr
+                      ? &pool.import(*expression)
+                      : &pool.make<BinaryExpression>(ExpressionType::And, *conjunction, pool.import(*expression));
+    }
+    return conjunction;
+}
@@ -1,9 +1,280 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
 #include "abstract_expression.hpp"
-#include "abstract_lqp_node.hpp"
 
+/// Column of a stored table, referenced by name. `table` is empty for unqualified columns.
 class ColumnExpression final : public AbstractExpression {
 private:
-    LQPNodeRef lqp_node;
+    std::string table;
+    std::string column;
+public:
+    ColumnExpression(std::string table, std::string column)
+            : AbstractExpression(ExpressionType::Column)
+            , table(std::move(table))
+            , column(std::move(column)) {}
+
+    [[nodiscard]] const std::string& get_table() const { return table; }
+
+    [[nodiscard]] const std::string& get_column() const { return column; }
+
+    [[nodiscard]] std::size_t shallow_hash() const override {
+        auto hash = std::hash<std::string>()(table);
+        utils::hash_combine(hash, std::hash<std::string>()(column));
+        return hash;
+    }
+
+    [[nodiscard]] bool shallow_equals(const AbstractExpression& other) const override {
+        const auto& other_column = static_cast<const ColumnExpression&>(other);
+        return table == other_column.table && column == other_column.column;
+    }
+};
+
+class ConstantExpression final : public AbstractExpression {
+public:
+    using Value = std::variant<double, std::string>;
+
+private:
+    Value value;
+
+public:
+    explicit ConstantExpression(Value value)
+            : AbstractExpression(ExpressionType::Constant)
+            , value(std::move(value)) {}
+
+    [[nodiscard]] const Value& get_value() const { return value; }
+
+    [[nodiscard]] std::size_t shallow_hash() const override { return std::hash<Value>()(value); }
+
+    [[nodiscard]] bool shallow_equals(const AbstractExpression& other) const override {
+        return value == static_cast<const ConstantExpression&>(other).value;
+    }
 };
+
+/// The constant with the given index in a list of parameters, printed as `$<index>`.
+class ParameterExpression final : public AbstractExpression {
+private:
+    std::size_t index;
+public:
+    explicit ParameterExpression(std::size_t index)
+            : AbstractExpression(ExpressionType::Parameter)
+            , index(index) {}
+
+    [[nodiscard]] std::size_t get_index() const { return index; }
+
+    [[nodiscard]] std::size_t shallow_hash() const override { return index; }
+
+    [[nodiscard]] bool shallow_equals(const AbstractExpression& other) const override {
+        return index == static_cast<const ParameterExpression&>(other).index;
+    }
+};
+
+/// Call of a function not known to the optimizer, such as `is_valid(tbl_a.x)`.
+class FunctionExpression final : public AbstractExpression {
+private:
+    std::string name;
+    std::vector<const AbstractExpression*> arguments;
+public:
+    FunctionExpression(std::string name, std::vector<const AbstractExpression*> arguments)
+            : AbstractExpression(ExpressionType::Function)
+            , name(std::move(name))
+            , arguments(std::move(arguments)) {}
+
+    [[nodiscard]] const std::string& get_name() const { return name; }
+
+    [[nodiscard]] std::span<const AbstractExpression* const> get_arguments() const override { return arguments; }
+
+    [[nodiscard]] std::size_t shallow_hash() const override { return std::hash<std::string>()(name); }
+
+    [[nodiscard]] bool shallow_equals(const AbstractExpression& other) const override {
+        return name == static_cast<const FunctionExpression&>(other).name;
+    }
+};
+
+[[nodiscard]] constexpr bool is_comparison(ExpressionType type) {
+    return type >= ExpressionType::Equals && type <= ExpressionType::GreaterThanEquals;
+}
+
+[[nodiscard]] constexpr bool is_binary_operator(ExpressionType type) {
+    return type >= ExpressionType::Sum && type <= ExpressionType::Or;
+}
+
+/// Arithmetic, comparison and logical operators.
+class BinaryExpression final : public AbstractExpression {
+private:
+    std::array<const AbstractExpression*, 2> arguments;
+public:
+    BinaryExpression(ExpressionType type, const AbstractExpression& left, const AbstractExpression& right)
+            : AbstractExpression(type)
+            , arguments{ &left, &right } {
+        if (!is_binary_operator(type)) throw std::logic_error("cannot create binary expression: not an operator");
+    }
+
+    [[nodiscard]] const AbstractExpression& get_left() const { return *arguments[0]; }
+
+    [[nodiscard]] const AbstractExpression& get_right() const { return *arguments[1]; }
+
+    [[nodiscard]] std::span<const AbstractExpression* const> get_arguments() const override { return arguments; }
+
+    [[nodiscard]] std::size_t shallow_hash() const override { return 0; }
+
+    [[nodiscard]] bool shallow_equals(const AbstractExpression& /* other */) const override { return true; }
+};
+
+/// The comparison with swapped operands: `a < b` is `b > a`.
+[[nodiscard]] constexpr ExpressionType mirror_comparison(ExpressionType type) {
+    switch (type) {
+        case ExpressionType::LessThan: return ExpressionType::GreaterThan;
+        case ExpressionType::LessThanEquals: return ExpressionType::GreaterThanEquals;
+        case ExpressionType::GreaterThan: return ExpressionType::LessThan;
+        case ExpressionType::GreaterThanEquals: return ExpressionType::LessThanEquals;
+        default: return type;
+    }
+}
+
+[[nodiscard]] constexpr std::string_view get_operator_symbol(ExpressionType type) {
+    switch (type) {
+        case ExpressionType::Sum: return "+";
+        case ExpressionType::Equals: return "=";
+        case ExpressionType::NotEquals: return "!=";
+        case ExpressionType::LessThan: return "<";
+        case ExpressionType::LessThanEquals: return "<=";
+        case ExpressionType::GreaterThan: return ">";
+        case ExpressionType::GreaterThanEquals: return ">=";
+        case ExpressionType::And: return "AND";
+        case ExpressionType::Or: return "OR";
+        default: return "";
+    }
+}
+
+namespace detail {
+
+/// Binding strength of operators, for printing parentheses where needed. Operands bind strongest.
+[[nodiscard]] constexpr int get_precedence(ExpressionType type) {
+    if (type == ExpressionType::Or) return 0;
+    if (type == ExpressionType::And) return 1;
+    if (is_comparison(type)) return 2;
+    if (type == ExpressionType::Sum) return 3;
+    return 4;
+}
+
+inline void append_expression(std::string& result, const AbstractExpression& expression) {
+    switch (expression.type) {
+        case ExpressionType::Column: {
+            const auto& column = static_cast<const ColumnExpression&>(expression);
+            if (!column.get_table().empty()) result.append(column.get_table()).append(".");
+            result.append(column.get_column());
+            return;
+        }
+        case ExpressionType::Constant: {
+            const auto& value = static_cast<const ConstantExpression&>(expression).get_value();
+            if (const auto* text = std::get_if<std::string>(&value)) {
+                result.append("'").append(*text).append("'");
+                return;
+            }
+            std::array<char, 32> buffer;
+            auto [end, _] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), std::get<double>(value));
+            result.append(buffer.data(), end);
+            return;
+        }
+        case ExpressionType::Parameter:
+            result.append("$").append(std::to_string(static_cast<const ParameterExpression&>(expression).get_index()));
+            return;
+        case ExpressionType::Function: {
+            result.append(static_cast<const FunctionExpression&>(expression).get_name()).append("(");
+            auto first = true;
+            for (const auto& argument : expression.get_arguments()) {
+                if (!first) result.append(", ");
+                first = false;
+                append_expression(result, *argument);
+            }
+            result.append(")");
+            return;
+        }
+        default:
+            break;
+    }
+
+    // Operators: comparisons do not chain, so a comparison operand of a comparison is parenthesized too.
+    auto precedence = get_precedence(expression.type);
+    for (std::size_t i = 0; i < 2; ++i) {
+        const auto& argument = *expression.get_arguments()[i];
+        auto argument_precedence = get_precedence(argument.type);
+        auto parenthesize = argument_precedence < precedence
+                            || (argument_precedence == precedence && (is_comparison(expression.type) || i == 1));
+        if (i == 1) result.append(" ").append(get_operator_symbol(expression.type)).append(" ");
+        if (parenthesize) result.append("(");
+        append_expression(result, argument);
+        if (parenthesize) result.append(")");
+    }
+}
+
+} // namespace detail
+
+/// SQL-like text form of the expression, which `parse_expression` turns back into an equal expression.
+[[nodiscard]] inline std::string to_string(const AbstractExpression& expression) {
+    std::string result;
+    detail::append_expression(result, expression);
+    return result;
+}
+
+/// Calls `visitor` for the expression and all its subexpressions, in pre-order.
+template <typename Visitor>
+void visit_expression(const AbstractExpression& expression, Visitor&& visitor) {
+    std::vector<const AbstractExpression*> stack{ &expression };
+    while (!stack.empty()) {
+        const auto* current = stack.back();
+        stack.pop_back();
+        visitor(*current);
+        auto arguments = current->get_arguments();
+        for (auto argument = arguments.rbegin(); argument != arguments.rend(); ++argument) stack.push_back(*argument);
+    }
+}
+
+/// Operands of nested conjunctions, left to right, such as `a`, `b` and `c` for `a AND (b AND c)`. The expression
+/// itself if it is not a conjunction.
+[[nodiscard]] inline std::vector<const AbstractExpression*> get_conjuncts(const AbstractExpression& expression) {
+    std::vector<const AbstractExpression*> conjuncts;
+    std::vector<const AbstractExpression*> stack{ &expression };
+    while (!stack.empty()) {
+        const auto* current = stack.back();
+        stack.pop_back();
+        if (current->type != ExpressionType::And) {
+            conjuncts.push_back(current);
+            continue;
+        }
+        stack.push_back(current->get_arguments()[1]);
+        stack.push_back(current->get_arguments()[0]);
+    }
+    return conjuncts;
+}
+
+/// Whether the expression compares two columns for equality, such as `tbl_a.x = tbl_b.y`.
+[[nodiscard]] inline bool is_column_equality(const AbstractExpression& expression) {
+    if (expression.type != ExpressionType::Equals) return false;
+    auto arguments = expression.get_arguments();
+    return arguments[0]->type == ExpressionType::Column && arguments[1]->type == ExpressionType::Column;
+}
+
+/// Names of the tables an expression references through qualified columns such as `tbl_a.x`, in order of first
+/// reference.
+[[nodiscard]] inline std::vector<std::string> get_referenced_table_names(const AbstractExpression& expression) {
+    std::vector<std::string> names;
+    visit_expression(expression, [&](const AbstractExpression& subexpression) {
+        if (subexpression.type != ExpressionType::Column) return;
+        const auto& table = static_cast<const ColumnExpression&>(subexpression).get_table();
+        if (!table.empty() && std::ranges::find(names, table) == names.end()) names.push_back(table);
+    });
+    return names;
+}
+
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "reverse_index.hpp"
+#include "small_vector.hpp"
+
+/// Default id lookup for `FlatReverseDAGIndex`: the node's own dense id.
+template <typename T>
+struct NodeIdOf {
+    [[nodiscard]] std::uint32_t operator()(const T& node) const { return node.get_id(); }
+};
+
+/// Drop-in alternative to `ReverseDAGIndex` for nodes carrying dense integer ids.
+/// Parent lists are stored in a vector indexed by id and keep the first `InlineParents` parents inline,
+/// so that the common case of one or two parents needs neither hashing nor allocation.
+template <typename T, typename IdOf = NodeIdOf<T>, std::size_t InlineParents = 2>
+class FlatReverseDAGIndex final {
+private:
+    using ParentList = utils::SmallVector<const T*, InlineParents>;
+
+    std::vector<ParentList> node_parents;
+    [[no_unique_address]] IdOf id_of;
+
+    [[nodiscard]] const ParentList* find_parents(const T& node) const {
+        auto id = id_of(node);
+        return id < node_parents.size() ? &node_parents[id] : nullptr;
+    }
+
+    ParentList& get_or_add_parents(const T& node) {
+        auto id = id_of(node);
+        if (id >= node_parents.size()) node_parents.resize(id + 1);
+        return node_parents[id];
+    }
+
+public:
+    FlatReverseDAGIndex() = default;
+    explicit FlatReverseDAGIndex(IdOf id_of) : id_of(std::move(id_of)) {}
+
+    [[nodiscard]] int get_parent_count(const T& node) const {
+        auto parents = find_parents(node);
+        return parents ? static_cast<int>(parents->size()) : 0;
+    }
+
+    /// Yields `(input, parent)` pairs, mirroring the element type of `ReverseDAGIndex`.
+    class NodeParentIterator final {
+    public:
+        class iterator final {
+            const T* input = nullptr;
+            const T* const* parent = nullptr;
+        public:
+            using value_type = std::pair<const T*, const T*>;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() = default;
+            iterator(const T* input, const T* const* parent) : input(input), parent(parent) {}
+
+            value_type operator*() const { return { input, *parent }; }
+            iterator& operator++() { ++parent; return *this; }
+            iterator operator++(int) { auto copy = *this; ++parent; return copy; }
+            bool operator==(const iterator& other) const { return parent == other.parent; }
+        };
+
+    private:
+        const iterator begin_iter;
+        const iterator end_iter;
+
+    public:
+        NodeParentIterator(const T& input, const ParentList* parents)
+                : begin_iter(&input, parents ? parents->begin() : nullptr)
+                , end_iter(&input, parents ? parents->end() : nullptr) {}
+        [[nodiscard]] iterator begin() const { return begin_iter; }
+        [[nodiscard]] iterator end() const { return end_iter; }
+    };
+    static_assert(std::ranges::range<NodeParentIterator>);
+
+    NodeParentIterator get_parents(const T& node) const {
+        return NodeParentIterator(node, find_parents(node));
+    }
+
+    void add(const T& input, const T& parent) {
+        auto& parents = get_or_add_parents(input);
+        // Verify the link does not already exist.
+        if (std::ranges::find(parents, &parent) != parents.end()) {
+            throw std::logic_error("cannot add link: link already exists");
+        }
+        parents.push_back(&parent);
+    }
+
+    /// Adds a link without checking whether it exists, for building an index from the links of a valid one.
+    void append(const T& input, const T& parent) {
+        get_or_add_parents(input).push_back(&parent);
+    }
+
+    /// Allocates parent lists for ids below `id_bound`.
+    void reserve(std::uint32_t id_bound) {
+        if (id_bound > node_parents.size()) node_parents.resize(id_bound);
+    }
+
+    void remove(const T& input, const T& parent) {
+        auto parents = find_parents(input);
+        auto parent_link = parents ? std::ranges::find(*parents, &parent) : nullptr;
+        if (parents == nullptr || parent_link == parents->end()) {
+            throw std::logic_error("cannot remove parent link: not found");
+        }
+        node_parents[id_of(input)].erase(static_cast<std::size_t>(parent_link - parents->begin()));
+    }
+
+    void replace_input(const T& node, const T& new_node) {
+        if (get_parent_count(new_node) != 0) {
+            throw std::logic_error("cannot replace input: new node already has parents");
+        }
+        if (get_parent_count(node) == 0) return;
+
+        // The new node has no parents, so the list can be moved over without checking for duplicates.
+        auto& new_parents = get_or_add_parents(new_node);
+        auto& old_parents = node_parents[id_of(node)];
+        new_parents = std::move(old_parents);
+        old_parents.clear();
+    }
+};
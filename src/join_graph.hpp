@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cardinality_estimator.hpp"
+#include "expression_pool.hpp"
+#include "expressions.hpp"
+#include "lqp.hpp"
+#include "lqp_batch.hpp"
+#include "lqp_nodes.hpp"
+
+/// Whether the node belongs to a join block: an inner join, or a chain of predicates on top of one. Joins,
+/// join conditions and predicates within a block can be reordered freely. Other join modes end a block.
+inline bool is_join_block_node(const LQP& lqp, const AbstractLQPNode& node) {
+    const AbstractLQPNode* current = &node;
+    while (current->type == LQPNodeType::Predicate) {
+        current = &static_cast<const PredicateNode*>(current)->get_input().get();
+        if (lqp.get_parent_count(*current) != 1) return false;
+    }
+    return current->type == LQPNodeType::Join && static_cast<const JoinNode*>(current)->get_mode() == JoinMode::Inner;
+}
+
+/// Whether the node is the topmost node of a join block.
+inline bool is_join_block_root(const LQP& lqp, const AbstractLQPNode& node) {
+    if (!is_join_block_node(lqp, node)) return false;
+    if (lqp.get_parent_count(node) != 1) return true;
+    return !is_join_block_node(lqp, *(*lqp.get_parents(node).begin()).second);
+}
+
+/// Bushy join order over the relations of a `JoinGraph`. Operands below the relation count refer to relations,
+/// the others to `joins[operand - relation count]`. Inputs come before the joins using them, the last join is the
+/// root.
+struct JoinTree {
+    struct Join {
+        std::size_t left;
+        std::size_t right;
+    };
+
+    std::vector<Join> joins;
+};
+
+/// Relations and predicates of a join block. Relations are the inputs of the block: the subplans below its joins
+/// that are not inner joins themselves, or that are shared with other parts of the plan. The conjuncts of join
+/// conditions are predicates too.
+struct JoinGraph {
+    struct Predicate {
+        const AbstractExpression* expression;
+        /// Relations the predicate references, in ascending order. Empty if the referenced tables cannot be
+        /// attributed to relations unambiguously, in which case the predicate stays on top of the block.
+        std::vector<std::size_t> relations;
+        double selectivity;
+    };
+
+    const AbstractLQPNode* root = nullptr;
+    std::vector<const AbstractLQPNode*> relations;
+    std::vector<double> relation_cardinalities;
+    /// In plan order, top to bottom.
+    std::vector<Predicate> predicates;
+    /// Joins and predicates of the block, each before its inputs.
+    std::vector<const AbstractLQPNode*> nodes;
+    /// Current join order of the block.
+    JoinTree current_tree;
+};
+
+/// Extracts the join graph of the block rooted at `root`, which must satisfy `is_join_block_root`. Returns a graph
+/// without relations if the block reaches one relation through several paths.
+inline JoinGraph extract_join_graph(const LQP& lqp, const AbstractLQPNode& root,
+                                    AbstractCardinalityEstimator& estimator) {
+    JoinGraph graph;
+    graph.root = &root;
+
+    lqp.visit(root, [&](const AbstractLQPNode& node) {
+        if (&node == &root || (lqp.get_parent_count(node) == 1 && is_join_block_node(lqp, node))) {
+            graph.nodes.push_back(&node);
+            return true;
+        }
+        graph.relations.push_back(&node);
+        return false;
+    });
+
+    // A subplan joined with itself through different paths cannot be split into distinct relations.
+    auto relations = graph.relations;
+    std::ranges::sort(relations);
+    if (std::ranges::adjacent_find(relations) != relations.end()) {
+        graph.relations.clear();
+        return graph;
+    }
+
+    // Rebuild the current join order bottom-up. Predicates are transparent.
+    auto relation_count = graph.relations.size();
+    std::unordered_map<const AbstractLQPNode*, std::size_t> operands;
+    for (std::size_t i = 0; i < relation_count; ++i) operands.emplace(graph.relations[i], i);
+    for (auto node = graph.nodes.rbegin(); node != graph.nodes.rend(); ++node) {
+        auto inputs = (*node)->get_input_nodes();
+        if ((*node)->type == LQPNodeType::Predicate) {
+            operands.emplace(*node, operands.at(&inputs[0]));
+            continue;
+        }
+        graph.current_tree.joins.push_back({ operands.at(&inputs[0]), operands.at(&inputs[1]) });
+        operands.emplace(*node, relation_count + graph.current_tree.joins.size() - 1);
+    }
+
+    // Attribute table names to relations. Names occurring in several relations are ambiguous.
+    constexpr auto ambiguous = ~std::size_t{0};
+    std::unordered_map<std::string, std::size_t> table_relations;
+    for (std::size_t i = 0; i < relation_count; ++i) {
+        graph.relation_cardinalities.push_back(estimator.estimate_cardinality(lqp, *graph.relations[i]));
+        lqp.visit<LQP::VisitOrder::PreOrder, LQP::SharedNodes::VisitOnce>(*graph.relations[i], [&](const AbstractLQPNode& node) {
+            if (node.type != LQPNodeType::StoredTable) return;
+            auto [relation, inserted] = table_relations.emplace(static_cast<const StoredTableNode&>(node).get_name(), i);
+            if (!inserted && relation->second != i) relation->second = ambiguous;
+        });
+    }
+
+    auto add_predicate = [&](const AbstractExpression& predicate) {
+        std::vector<std::size_t> relations;
+        for (const auto& table_name : get_referenced_table_names(predicate)) {
+            auto relation = table_relations.find(table_name);
+            if (relation == table_relations.end() || relation->second == ambiguous) {
+                relations.clear();
+                break;
+            }
+            relations.push_back(relation->second);
+        }
+        std::ranges::sort(relations);
+        relations.erase(std::unique(relations.begin(), relations.end()), relations.end());
+        graph.predicates.push_back({ &predicate, std::move(relations), estimator.estimate_selectivity(predicate) });
+    };
+    for (auto node : graph.nodes) {
+        if (node->type == LQPNodeType::Predicate) {
+            add_predicate(static_cast<const PredicateNode*>(node)->get_predicate());
+            continue;
+        }
+        const auto* condition = static_cast<const JoinNode*>(node)->get_condition();
+        if (condition == nullptr) continue;
+        for (const auto* conjunct : get_conjuncts(*condition)) add_predicate(*conjunct);
+    }
+    return graph;
+}
+
+/// Estimated output cardinality of joining the given relations, a bitset over the relations of the graph. Applies
+/// the selectivities of all predicates referencing only these relations.
+inline double estimate_join_cardinality(const JoinGraph& graph, const std::vector<bool>& relations) {
+    double cardinality = 1;
+    for (std::size_t i = 0; i < relations.size(); ++i) {
+        if (relations[i]) cardinality *= graph.relation_cardinalities[i];
+    }
+    for (const auto& predicate : graph.predicates) {
+        if (predicate.relations.empty()) continue;
+        if (std::ranges::all_of(predicate.relations, [&](auto relation) { return relations[relation]; })) {
+            cardinality *= predicate.selectivity;
+        }
+    }
+    return cardinality;
+}
+
+/// Sum of the estimated output cardinalities of all joins of the tree (C_out).
+inline double estimate_join_tree_cost(const JoinGraph& graph, const JoinTree& tree) {
+    auto relation_count = graph.relations.size();
+    std::vector<std::vector<bool>> join_relations;
+    join_relations.reserve(tree.joins.size());
+
+    auto add_operand = [&](std::vector<bool>& relations, std::size_t operand) {
+        if (operand < relation_count) {
+            relations[operand] = true;
+            return;
+        }
+        const auto& operand_relations = join_relations[operand - relation_count];
+        for (std::size_t i = 0; i < relation_count; ++i) {
+            if (operand_relations[i]) relations[i] = true;
+        }
+    };
+
+    double cost = 0;
+    for (const auto& join : tree.joins) {
+        std::vector<bool> relations(relation_count);
+        add_operand(relations, join.left);
+        add_operand(relations, join.right);
+        cost += estimate_join_cardinality(graph, relations);
+        join_relations.push_back(std::move(relations));
+    }
+    return cost;
+}
+
+/// Replaces the join block the graph was extracted from with new nodes joining its relations in the given order,
+/// and returns the new root of the block. Every predicate is placed at the lowest join covering the relations it
+/// references, or above its relation if it references only one. The predicates placed at a join form its condition,
+/// as the joins of the block are inner joins, so that join ordering turns filtered cross products into joins on
+/// their keys. The block is replaced in a single `LQPMutationBatch`.
+inline const AbstractLQPNode& rebuild_join_block(LQP& lqp, const JoinGraph& graph, const JoinTree& tree) {
+    LQPMutationBatch batch(lqp);
+    auto relation_count = graph.relations.size();
+    std::vector<bool> placed(graph.predicates.size());
+
+    // Takes the predicates not placed yet that reference only the given relations, or all of them, bottom to top.
+    auto take_predicates = [&](const std::vector<bool>* relations) {
+        std::vector<std::size_t> taken;
+        for (auto i = graph.predicates.size(); i-- > 0;) {
+            const auto& predicate = graph.predicates[i];
+            if (placed[i]) continue;
+            if (relations != nullptr) {
+                if (predicate.relations.empty()) continue;
+                if (!std::ranges::all_of(predicate.relations, [&](auto relation) { return (*relations)[relation]; })) {
+                    continue;
+                }
+            }
+            taken.push_back(i);
+            placed[i] = true;
+        }
+        return taken;
+    };
+
+    // Predicates are applied bottom to top, keeping the relative order of those placed together.
+    auto place_predicates = [&](const AbstractLQPNode* node, const std::vector<std::size_t>& predicates) {
+        for (auto i : predicates) node = &batch.make_node<PredicateNode>(*graph.predicates[i].expression, *node);
+        return node;
+    };
+
+    std::vector<const AbstractLQPNode*> operands;
+    std::vector<std::vector<bool>> operand_relations;
+    operands.reserve(relation_count + tree.joins.size());
+    operand_relations.reserve(relation_count + tree.joins.size());
+    for (std::size_t i = 0; i < relation_count; ++i) {
+        operand_relations.emplace_back(relation_count);
+        operand_relations.back()[i] = true;
+        operands.push_back(place_predicates(graph.relations[i], take_predicates(&operand_relations.back())));
+    }
+    for (const auto& join : tree.joins) {
+        std::vector<bool> relations(relation_count);
+        for (std::size_t i = 0; i < relation_count; ++i) {
+            relations[i] = operand_relations[join.left][i] || operand_relations[join.right][i];
+        }
+        auto predicates = take_predicates(&relations);
+
+        // Predicates are combined in plan order.
+        std::vector<const AbstractExpression*> conjuncts;
+        for (auto i = predicates.rbegin(); i != predicates.rend(); ++i) conjuncts.push_back(graph.predicates[*i].expression);
+        const auto* condition = make_conjunction(lqp.get_expression_pool(), conjuncts);
+
+        operands.push_back(&batch.make_node<JoinNode>(JoinMode::Inner, condition, *operands[join.left], *operands[join.right]));
+        operand_relations.push_back(std::move(relations));
+    }
+    const auto& new_root = *place_predicates(operands.back(), take_predicates(nullptr));
+
+    batch.replace_node(*graph.root, new_root);
+    for (auto node : graph.nodes) batch.remove_node(*node);
+    batch.commit();
+    return new_root;
+}
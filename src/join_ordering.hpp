@@ -0,0 +1,341 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "abstract_rule.hpp"
+#include "cardinality_estimator.hpp"
+#include "join_graph.hpp"
+
+/// Exhaustive enumeration of bushy join trees by dynamic programming over connected subgraph and complement pairs
+/// (DPccp, Moerkotte and Neumann 2006). Relation sets are bitsets in a 64-bit mask, the table of best plans has an
+/// entry per subset of the relations.
+///
+/// Cross products are only considered between relations that are not connected by predicates at all. Each pair of
+/// subsets is emitted once, after both subsets, so its best plans are known when it is looked at.
+class DPccpJoinEnumerator final {
+public:
+    static constexpr std::size_t max_relations = 20;
+
+private:
+    using RelationSet = std::uint64_t;
+
+    struct Plan {
+        double cost = std::numeric_limits<double>::infinity();
+        double cardinality = 0;
+        RelationSet left = 0;
+        RelationSet right = 0;
+    };
+
+    struct Predicate {
+        RelationSet relations;
+        double selectivity;
+    };
+
+    std::size_t relation_count;
+    std::vector<RelationSet> neighbours;
+    std::vector<Predicate> predicates;
+    std::vector<Plan> plans;
+
+    /// Relations with an index up to and including `i`.
+    [[nodiscard]] static RelationSet up_to(std::size_t i) { return (RelationSet{2} << i) - 1; }
+
+    [[nodiscard]] RelationSet get_neighbours(RelationSet relations) const {
+        RelationSet result = 0;
+        for (auto remaining = relations; remaining != 0; remaining &= remaining - 1) {
+            result |= neighbours[std::countr_zero(remaining)];
+        }
+        return result & ~relations;
+    }
+
+    /// Calls `function` for every non-empty subset of `relations`, in ascending order.
+    template <typename Function>
+    static void for_each_subset(RelationSet relations, Function&& function) {
+        for (RelationSet subset = (0 - relations) & relations; subset != 0; subset = (subset - relations) & relations) {
+            function(subset);
+        }
+    }
+
+    /// Emits every connected superset of `relations` built from relations outside `excluded`.
+    template <typename Emit>
+    void enumerate_connected_sets(RelationSet relations, RelationSet excluded, Emit&& emit) const {
+        auto candidates = get_neighbours(relations) & ~excluded;
+        if (candidates == 0) return;
+        for_each_subset(candidates, [&](RelationSet subset) { emit(relations | subset); });
+        for_each_subset(candidates, [&](RelationSet subset) {
+            enumerate_connected_sets(relations | subset, excluded | candidates, emit);
+        });
+    }
+
+    /// Emits every connected complement of `relations`: connected sets adjacent to it with a higher lowest index.
+    template <typename Emit>
+    void enumerate_complements(RelationSet relations, Emit&& emit) const {
+        auto excluded = up_to(std::countr_zero(relations)) | relations;
+        auto candidates = get_neighbours(relations) & ~excluded;
+        for (auto i = relation_count; i-- > 0;) {
+            auto relation = RelationSet{1} << i;
+            if ((candidates & relation) == 0) continue;
+            emit(relation);
+            enumerate_connected_sets(relation, excluded | (candidates & up_to(i)), emit);
+        }
+    }
+
+    void emit_pair(RelationSet left, RelationSet right) {
+        auto relations = left | right;
+        auto& plan = plans[relations];
+        // The cardinality of a set does not depend on how it is split, so it is computed on the first visit only.
+        if (plan.left == 0) {
+            plan.cardinality = plans[left].cardinality * plans[right].cardinality;
+            for (const auto& predicate : predicates) {
+                auto applies = (predicate.relations & ~relations) == 0;
+                auto applied_below = (predicate.relations & ~left) == 0 || (predicate.relations & ~right) == 0;
+                if (applies && !applied_below) plan.cardinality *= predicate.selectivity;
+            }
+        }
+
+        auto cost = plan.cardinality + plans[left].cost + plans[right].cost;
+        if (plan.left != 0 && cost >= plan.cost) return;
+        // The larger input goes left, the build side of a hash join goes right.
+        if (plans[left].cardinality < plans[right].cardinality) std::swap(left, right);
+        plan.cost = cost;
+        plan.left = left;
+        plan.right = right;
+    }
+
+    std::size_t add_to_tree(JoinTree& tree, RelationSet relations) const {
+        if (std::has_single_bit(relations)) return static_cast<std::size_t>(std::countr_zero(relations));
+        const auto& plan = plans[relations];
+        auto left = add_to_tree(tree, plan.left);
+        auto right = add_to_tree(tree, plan.right);
+        tree.joins.push_back({ left, right });
+        return relation_count + tree.joins.size() - 1;
+    }
+
+public:
+    explicit DPccpJoinEnumerator(const JoinGraph& graph)
+            : relation_count(graph.relations.size())
+            , neighbours(relation_count) {
+        if (relation_count > max_relations) {
+            throw std::logic_error("cannot enumerate join orders: too many relations");
+        }
+
+        for (const auto& predicate : graph.predicates) {
+            RelationSet relations = 0;
+            for (auto relation : predicate.relations) relations |= RelationSet{1} << relation;
+            if (relations == 0) continue;
+            predicates.push_back({ relations, predicate.selectivity });
+            for (auto relation : predicate.relations) neighbours[relation] |= relations & ~(RelationSet{1} << relation);
+        }
+
+        // Connect unconnected components with each other, allowing cross products between them.
+        std::vector<RelationSet> components;
+        RelationSet covered = 0;
+        for (std::size_t i = 0; i < relation_count; ++i) {
+            if (covered & (RelationSet{1} << i)) continue;
+            RelationSet component = RelationSet{1} << i;
+            for (auto reachable = get_neighbours(component); reachable != 0; reachable = get_neighbours(component)) {
+                component |= reachable;
+            }
+            components.push_back(component);
+            covered |= component;
+        }
+        for (auto component : components) {
+            for (auto remaining = component; remaining != 0; remaining &= remaining - 1) {
+                neighbours[std::countr_zero(remaining)] |= covered & ~component;
+            }
+        }
+
+        plans.resize(std::size_t{1} << relation_count);
+        for (std::size_t i = 0; i < relation_count; ++i) {
+            auto cardinality = graph.relation_cardinalities[i];
+            for (const auto& predicate : predicates) {
+                if (predicate.relations == RelationSet{1} << i) cardinality *= predicate.selectivity;
+            }
+            plans[RelationSet{1} << i] = { 0, cardinality, 0, 0 };
+        }
+    }
+
+    /// Finds the cheapest join tree under the C_out cost model.
+    [[nodiscard]] JoinTree enumerate() {
+        for (auto i = relation_count; i-- > 0;) {
+            auto emit_connected_set = [&](RelationSet relations) {
+                enumerate_complements(relations, [&](RelationSet complement) { emit_pair(relations, complement); });
+            };
+            auto relation = RelationSet{1} << i;
+            emit_connected_set(relation);
+            enumerate_connected_sets(relation, up_to(i), emit_connected_set);
+        }
+
+        JoinTree tree;
+        if (relation_count > 1) add_to_tree(tree, up_to(relation_count - 1));
+        return tree;
+    }
+};
+
+/// Greedy operator ordering (Fegaras 1998) for join graphs too large for exhaustive enumeration. Starts with every
+/// relation as a tree of its own and repeatedly joins the two trees connected by predicates whose join has the
+/// smallest estimated result, until one tree is left. Trees are only joined by a cross product if no predicate
+/// connects any two of them.
+///
+/// Each of the n - 1 steps looks at every predicate once, so the enumeration takes O(n * p) for p predicates: about
+/// quadratic in the number of relations for the sparse join graphs of generated queries.
+class GreedyJoinEnumerator final {
+private:
+    const JoinGraph& graph;
+
+public:
+    explicit GreedyJoinEnumerator(const JoinGraph& graph) : graph(graph) {}
+
+    [[nodiscard]] JoinTree enumerate() const {
+        struct Tree {
+            std::size_t operand;
+            double cardinality;
+            std::vector<std::size_t> relations;
+        };
+
+        auto relation_count = graph.relations.size();
+        std::vector<Tree> trees;
+        std::vector<std::size_t> relation_trees(relation_count);
+        std::vector<std::size_t> live_trees;
+        for (std::size_t i = 0; i < relation_count; ++i) {
+            trees.push_back({ i, graph.relation_cardinalities[i], { i } });
+            relation_trees[i] = i;
+            live_trees.push_back(i);
+        }
+
+        // Predicates on a single relation are applied to it up front, the others once their relations are joined.
+        std::vector<const JoinGraph::Predicate*> pending_predicates;
+        for (const auto& predicate : graph.predicates) {
+            if (predicate.relations.size() == 1) {
+                trees[predicate.relations[0]].cardinality *= predicate.selectivity;
+            } else if (predicate.relations.size() > 1) {
+                pending_predicates.push_back(&predicate);
+            }
+        }
+
+        JoinTree tree;
+        std::unordered_map<std::uint64_t, double> pair_selectivities;
+        while (live_trees.size() > 1) {
+            // Combined selectivity of the predicates between each pair of trees they connect.
+            pair_selectivities.clear();
+            for (auto predicate : pending_predicates) {
+                auto first = relation_trees[predicate->relations[0]];
+                auto second = first;
+                auto spans_more_trees = false;
+                for (auto relation : predicate->relations) {
+                    auto relation_tree = relation_trees[relation];
+                    if (relation_tree == first || relation_tree == second) continue;
+                    if (second != first) {
+                        spans_more_trees = true;
+                        break;
+                    }
+                    second = relation_tree;
+                }
+                if (spans_more_trees) continue;
+                auto key = (std::uint64_t{std::min(first, second)} << 32) | std::max(first, second);
+                pair_selectivities.emplace(key, 1.0).first->second *= predicate->selectivity;
+            }
+
+            // Ties are broken by tree index, keeping the order independent of the iteration order of the map.
+            std::size_t left = 0;
+            std::size_t right = 0;
+            auto best_cardinality = std::numeric_limits<double>::infinity();
+            std::uint64_t best_key = ~std::uint64_t{0};
+            for (const auto& [key, selectivity] : pair_selectivities) {
+                auto first = static_cast<std::size_t>(key >> 32);
+                auto second = static_cast<std::size_t>(key & 0xFFFFFFFF);
+                auto cardinality = trees[first].cardinality * trees[second].cardinality * selectivity;
+                if (cardinality < best_cardinality || (cardinality == best_cardinality && key < best_key)) {
+                    best_cardinality = cardinality;
+                    best_key = key;
+                    left = first;
+                    right = second;
+                }
+            }
+            if (pair_selectivities.empty()) {
+                // Nothing connects the trees: cross the two smallest ones.
+                std::ranges::partial_sort(live_trees, live_trees.begin() + 2, {}, [&](auto i) { return trees[i].cardinality; });
+                left = live_trees[0];
+                right = live_trees[1];
+                best_cardinality = trees[left].cardinality * trees[right].cardinality;
+            }
+
+            // The larger input goes left, the build side of a hash join goes right.
+            if (trees[left].cardinality < trees[right].cardinality) std::swap(left, right);
+            tree.joins.push_back({ trees[left].operand, trees[right].operand });
+
+            // Merge the smaller tree into the larger one.
+            auto [merged, absorbed] = trees[left].relations.size() >= trees[right].relations.size()
+                                      ? std::pair(left, right) : std::pair(right, left);
+            for (auto relation : trees[absorbed].relations) relation_trees[relation] = merged;
+            trees[merged].relations.insert(trees[merged].relations.end(), trees[absorbed].relations.begin(),
+                                           trees[absorbed].relations.end());
+            trees[absorbed].relations.clear();
+            trees[merged].operand = relation_count + tree.joins.size() - 1;
+            trees[merged].cardinality = best_cardinality;
+            std::erase(live_trees, absorbed);
+            std::erase_if(pending_predicates, [&](auto predicate) {
+                return std::ranges::all_of(predicate->relations, [&](auto relation) { return relation_trees[relation] == merged; });
+            });
+        }
+        return tree;
+    }
+};
+
+/// Reorders the joins of every join block by their estimated cost. Blocks of up to `max_exhaustive_relations`
+/// relations are enumerated exhaustively, see `DPccpJoinEnumerator`, larger ones greedily, see
+/// `GreedyJoinEnumerator`. A block is rebuilt only if the new order is cheaper than the current one, so applying the
+/// rule again leaves the plan unchanged.
+class JoinOrderingRule final : public AbstractRule {
+private:
+    /// Relative cost difference below which the current order is kept, so that rounding differences between
+    /// equivalent orders do not cause rebuilds.
+    static constexpr double min_improvement = 1e-9;
+
+    std::unique_ptr<AbstractCardinalityEstimator> estimator;
+    std::size_t max_exhaustive_relations;
+
+public:
+    static constexpr std::size_t default_max_exhaustive_relations = 14;
+
+    explicit JoinOrderingRule(std::unique_ptr<AbstractCardinalityEstimator> estimator =
+                                      std::make_unique<HeuristicCardinalityEstimator>(),
+                              std::size_t max_exhaustive_relations = default_max_exhaustive_relations)
+            : estimator(std::move(estimator))
+            , max_exhaustive_relations(max_exhaustive_relations) {
+        if (max_exhaustive_relations > DPccpJoinEnumerator::max_relations) {
+            throw std::logic_error("cannot create join ordering rule: too many relations for exhaustive enumeration");
+        }
+    }
+
+    [[nodiscard]] std::string_view name() const override { return "JoinOrdering"; }
+
+    void apply(LQP& lqp, std::uint64_t since_generation) override {
+        // Blocks are reordered bottom-up, so the blocks nested in the relations of a block are done before it.
+        std::vector<const AbstractLQPNode*> block_roots;
+        lqp.visit<LQP::VisitOrder::PreOrder, LQP::SharedNodes::VisitOnce>(lqp.get_root(), [&](const AbstractLQPNode& node) {
+            if (!lqp.subplan_changed_since(node, since_generation)) return false;
+            if (is_join_block_root(lqp, node)) block_roots.push_back(&node);
+            return true;
+        });
+
+        for (auto block_root = block_roots.rbegin(); block_root != block_roots.rend(); ++block_root) {
+            auto graph = extract_join_graph(lqp, **block_root, *estimator);
+            if (graph.relations.size() < 3) continue;
+
+            auto tree = graph.relations.size() <= max_exhaustive_relations ? DPccpJoinEnumerator(graph).enumerate()
+                                                                           : GreedyJoinEnumerator(graph).enumerate();
+            auto current_cost = estimate_join_tree_cost(graph, graph.current_tree);
+            if (estimate_join_tree_cost(graph, tree) < current_cost * (1 - min_improvement)) {
+                rebuild_join_block(lqp, graph, tree);
+            }
+        }
+    }
+};
@@ -1,97 +1,250 @@
 #pragma once
 
 #include <memory>
-#include <queue>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "abstract_lqp_node.hpp"
-#include "reverse_index.hpp"
+#include "arena.hpp"
+#include "expression_pool.hpp"
+#include "flat_reverse_index.hpp"
+
+/// Nodes copied by `clone_lqp`.
+enum class ClonedNodes { All, ReachableFromRoot };
 
 class LQP {
+    friend class LQPMutationBatch;
+    friend void clone_lqp(LQP& lqp, const LQP& source, ClonedNodes cloned_nodes);
+
     // TODO
     // - mutate itself
     // - integrity checks
     // - attach itself?
     // - split itself? / LQP view
-    // - topological-sort destructor
 private:
     using NodePtr = AbstractLQPNode *;
     using CNodePtr = const AbstractLQPNode *;
-    /// Owns the nodes and provides an indexed access for removal.
-    std::unordered_map<CNodePtr, std::unique_ptr<AbstractLQPNode>> nodes;
-    ReverseDAGIndex<AbstractLQPNode> node_parents;
+    struct NodeSlot {
+        NodePtr node = nullptr;
+        std::size_t size = 0;
+        /// Generation of the last change within the subplan rooted at the node.
+        std::uint64_t subplan_generation = 0;
+    };
+
+    /// Owns the memory of the nodes. Must outlive `nodes`, which only tracks them.
+    utils::Arena arena;
+    /// Owns the expressions of the nodes.
+    ExpressionPool expressions;
+    /// Indexed by node id. Slots of removed nodes are empty until their id is reused.
+    std::vector<NodeSlot> nodes;
+    /// Ids of empty slots in `nodes`, reused last-in first-out to keep the id range compact.
+    std::vector<std::uint32_t> free_ids;
+    FlatReverseDAGIndex<AbstractLQPNode> node_parents;
 
 //     LQPNodeRef root;
     NodePtr root = nullptr;
 
+    /// Incremented by every mutation, see `get_generation`.
+    std::uint64_t generation = 0;
+
     AbstractLQPNode& get_mutable(const AbstractLQPNode& node) {
         return const_cast<AbstractLQPNode&>(node);
     }
 
+    [[nodiscard]] std::uint32_t acquire_id() {
+        if (free_ids.empty()) {
+            nodes.emplace_back();
+            return static_cast<std::uint32_t>(nodes.size() - 1);
+        }
+        auto id = free_ids.back();
+        free_ids.pop_back();
+        return id;
+    }
+
+    /// Releases the node's id, destroys the node and returns its memory to the arena's free list.
+    void destroy_node(const AbstractLQPNode& node) {
+        auto& slot = get_slot(node);
+        auto size = std::exchange(slot, NodeSlot{}).size;
+        free_ids.push_back(node.id);
+
+        auto address = dynamic_cast<const void*>(&node);
+        std::destroy_at(&get_mutable(node));
+        arena.deallocate(const_cast<void*>(address), size);
+    }
+
+    /// Records a change of the node's inputs, or a loss of its parents, in the current generation for the node and
+    /// its ancestors, and drops their cached structural hashes.
+    void mark_changed(const AbstractLQPNode& node) {
+        // Ancestors of a node marked in this generation, which has no cached hash, are marked already.
+        std::vector<CNodePtr> stack{ &node };
+        while (!stack.empty()) {
+            auto el = stack.back();
+            stack.pop_back();
+            auto& subplan_generation = nodes[el->id].subplan_generation;
+            if (subplan_generation == generation && el->structural_hash == 0) continue;
+            subplan_generation = generation;
+            el->structural_hash = 0;
+            for (const auto& [_, parent] : node_parents.get_parents(*el)) stack.push_back(parent);
+        }
+    }
+
+    /// Creates a node as `make_node` does, without adding it to the parent index of its inputs.
+    template <typename T, typename... Args>
+    T& create_node(Args&&... args) {
+        static_assert(std::derived_from<T, AbstractLQPNode>);
+        T* node;
+        if constexpr (std::is_constructible_v<T, ExpressionPool&, Args&&...>) {
+            node = arena.create<T>(expressions, std::forward<Args>(args)...);
+        } else {
+            node = arena.create<T>(std::forward<Args>(args)...);
+        }
+        node->id = acquire_id();
+        nodes[node->id] = { node, sizeof(T), ++generation };
+        return *node;
+    }
+
+    NodeSlot& get_slot(const AbstractLQPNode& node) {
+        if (node.id >= nodes.size() || nodes[node.id].node != &node) {
+            throw std::logic_error("cannot remove node: not found in LQP");
+        }
+        return nodes[node.id];
+    }
+
 public:
+    /// Destroys all nodes in topological order (Kahn's algorithm), so that every node is destroyed before its inputs
+    /// and shared subplans are destroyed once. Node memory is then released by the arena in one go.
     ~LQP() {
-        // TODO topological sort to handle diamond schemas
+        // Number of parents not yet destroyed, per node id.
+        std::vector<int> remaining_parents(nodes.size());
+        std::vector<NodePtr> ready;
+        for (const auto& [node, size, _] : nodes) {
+            if (node == nullptr) continue;
+            remaining_parents[node->id] = node_parents.get_parent_count(*node);
+            if (remaining_parents[node->id] == 0) ready.push_back(node);
+        }
 
-        // Remove nodes sequentially starting with root and continuing through their inputs.
-        if (root == nullptr) { std::cerr << "node root not set" << std::endl; std::terminate(); }
-        std::queue<CNodePtr> removal_queue({ root });
+        while (!ready.empty()) {
+            auto node = ready.back();
+            ready.pop_back();
+            for (const auto& input : node->get_input_nodes()) {
+                if (--remaining_parents[input.id] == 0) ready.push_back(&get_mutable(input));
+            }
+            std::destroy_at(node);
+        }
+    }
 
-        while (!removal_queue.empty()) {
-            auto el = removal_queue.front();
-            removal_queue.pop();
+    /// Upper bound for the ids of live nodes, to size side tables indexed by node id.
+    [[nodiscard]] std::uint32_t get_node_id_bound() const { return static_cast<std::uint32_t>(nodes.size()); }
 
-            for (auto input : el->get_inputs()) {
-                removal_queue.push(&input.get());
-            }
+    [[nodiscard]] std::size_t get_node_count() const { return nodes.size() - free_ids.size(); }
 
-            remove_node(*el);
-        }
+    /// Pool of the expressions of the nodes, such as predicates. Expressions of other LQPs are imported into it when
+    /// passed to new nodes.
+    [[nodiscard]] ExpressionPool& get_expression_pool() { return expressions; }
+
+    [[nodiscard]] const ExpressionPool& get_expression_pool() const { return expressions; }
+
+    /// Counter advanced by every mutation of the LQP. Unchanged generation means an unchanged plan.
+    [[nodiscard]] std::uint64_t get_generation() const { return generation; }
+
+    /// Generation of the last change within the subplan rooted at `node`: creation of a node in it, a change of a
+    /// node's inputs, or a node losing parents, which can make rewrites applicable that require a single parent. Lets
+    /// passes and caches skip subplans that did not change since they last looked at them.
+    [[nodiscard]] std::uint64_t get_subplan_generation(const AbstractLQPNode& node) const {
+        return nodes[node.id].subplan_generation;
+    }
+
+    [[nodiscard]] bool subplan_changed_since(const AbstractLQPNode& node, std::uint64_t since_generation) const {
+        return get_subplan_generation(node) > since_generation;
     }
 
     // TODO don't allow the LQP to NOT have a root - create an LQPBuilder
     void set_root(const AbstractLQPNode& node) {
         // const_cast is allowed, because we have mutable access through `nodes`.
         root = const_cast<AbstractLQPNode *>(&node);
+        ++generation;
     }
 
-    const AbstractLQPNode& get_root() {
+    const AbstractLQPNode& get_root() const {
         if (root == nullptr) throw std::logic_error("LQP root not set");
         return *root;
     }
 
+    [[nodiscard]] auto get_parents(const AbstractLQPNode& node) const { return node_parents.get_parents(node); }
+
+    [[nodiscard]] int get_parent_count(const AbstractLQPNode& node) const {
+        return node_parents.get_parent_count(node);
+    }
+
+    /// Creates a node `T(args...)`. Nodes holding expressions are passed the expression pool of the LQP as first
+    /// constructor argument. Throws `std::logic_error` if the node uses an input twice.
     template <typename T, typename... Args>
     [[nodiscard]] const T& make_node(Args&&... args) {
-        static_assert(std::derived_from<T, AbstractLQPNode>);
+        auto& node = create_node<T>(std::forward<Args>(args)...);
 
-        // Create node.
-        auto node = std::make_unique<T>(std::forward<Args>(args)...);
-
-        // Store the node and the parent relation.
-        auto node_ptr = node.get();
-        for (auto& input : node->get_inputs()) {
-            node_parents.add(input, *node);
+        // Store the parent relation. A new node is not a parent of its inputs yet, so only the inputs themselves
+        // need to be checked for duplicates, not the parent lists, which can be long for shared inputs.
+        auto inputs = node.get_input_nodes();
+        if (inputs.size() == 2 && &inputs[0] == &inputs[1]) {
+            destroy_node(node);
+            throw std::logic_error("cannot add link: link already exists");
+        }
+        for (const auto& input : inputs) {
+            node_parents.append(input, node);
         }
-        nodes[node_ptr] = std::move(node);
-        return *node_ptr;
+        return node;
     }
 
     void remove_node(const AbstractLQPNode& node) {
-        // Assert invariants.
+        // Assert invariants. Membership first, as the other checks and the mutations index by the node's id.
+        get_slot(node);
         if (node.get_ref_count() != 0) { throw std::logic_error("cannot remove node: non-zero reference count"); }
         if (node_parents.get_parent_count(node)) { throw std::logic_error("cannot remove node: parent links exist"); }
 
         // Remove inputs' parent links to this node.
-        for (auto& input : node.get_inputs()) {
+        ++generation;
+        for (const auto& input : node.get_input_nodes()) {
             node_parents.remove(input, node);
+            mark_changed(input);
         }
 
         // Remove node.
-        if (nodes.erase(&node) == 0) { throw std::logic_error("cannot remove node: not found in LQP"); }
+        destroy_node(node);
+    }
+
+    /// Makes `parent` use `new_input` in place of `old_input`.
+    void replace_input(const AbstractLQPNode& parent, const AbstractLQPNode& old_input,
+                       const AbstractLQPNode& new_input) {
+        for (const auto& [_, new_input_parent] : node_parents.get_parents(new_input)) {
+            if (new_input_parent == &parent) {
+                throw std::logic_error("cannot replace input: new input is already an input of the parent");
+            }
+        }
+
+        get_mutable(parent).replace_input(old_input, new_input);
+        node_parents.remove(old_input, parent);
+        node_parents.add(new_input, parent);
+        ++generation;
+        mark_changed(parent);
+        mark_changed(old_input);
+    }
+
+    /// Makes all parents of `node` use `new_node` instead, and `new_node` the root if `node` was. Leaves `node` in
+    /// the LQP without parents.
+    void replace_node(const AbstractLQPNode& node, const AbstractLQPNode& new_node) {
+        // Collect first, as replacing inputs modifies the parent list.
+        std::vector<CNodePtr> parents;
+        for (const auto& [_, parent] : node_parents.get_parents(node)) parents.push_back(parent);
+        for (auto parent : parents) replace_input(*parent, node, new_node);
+        if (root == &node) set_root(new_node);
     }
 
     /// Substitutes a node for a new single-input node that has the old node as its input.
     template <typename T, typename... Args>
     const T& wrap_node_with(const AbstractLQPNode& node, Args&&... args) {
         static_assert(std::derived_from<T, AbstractSingleInputNode>);
+        auto parent_count = node_parents.get_parent_count(node);
 
         // Create a new node with the wrapped node as input.
         auto& new_node = make_node<T>(std::forward<Args>(args)..., node);
@@ -100,44 +253,119 @@ public:
         for (const auto& [_, parent_ptr] : node_parents.get_parents(node)) {
             if (parent_ptr == &new_node) continue;
             get_mutable(*parent_ptr).replace_input(node, new_node);
+            mark_changed(*parent_ptr);
         }
 
         // Update parent node index.
         node_parents.remove(node, new_node);
         node_parents.replace_input(node, new_node);
         node_parents.add(node, new_node);
+        if (parent_count > 1) mark_changed(node);
 
+        if (root == &node) set_root(new_node);
         return new_node;
     }
 
     void bypass_node(const AbstractSingleInputNode& node) {
+        get_slot(node);
+        ++generation;
         for (const auto& [_, parent] : node_parents.get_parents(node)) {
             get_mutable(*parent).replace_input(node, node.get_input());
+            mark_changed(*parent);
         }
 
         // TODO extract common logic with remove_node
         if (node.get_ref_count() != 0) { throw std::logic_error("cannot remove node: non-zero reference count"); }
-        if (nodes.erase(&node) == 0) { throw std::logic_error("cannot remove node: not found in LQP"); }
 
+        auto parent_count = node_parents.get_parent_count(node);
         node_parents.remove(node.get_input(), node);
         node_parents.replace_input(node, node.get_input());
+        if (parent_count == 0) mark_changed(node.get_input());
+        if (root == &node) set_root(node.get_input());
+        destroy_node(node);
     }
 
-    template<typename State> using Visitor = std::function<bool(const AbstractLQPNode&, State&)>;
-
     /// State is passed by value to the visit function and by reference to the visitor.
     /// When visitor modifies the state, the children receive a copy of that modified state.
-    template<typename State>
-    void visit(const AbstractLQPNode& node, const Visitor<State>& visitor, State state) {
-        auto visit_inputs = visitor(node, state);
-        if (!visit_inputs) return;
-        for (auto& input : node.get_inputs()) {
-            visit(input, visitor, state);
+    /// The visitor is called as `bool(const AbstractLQPNode&, State&)` and returns whether to visit the inputs.
+    template <typename State, typename Visitor>
+    void visit(const AbstractLQPNode& node, Visitor&& visitor, State state) const {
+        std::vector<std::pair<CNodePtr, State>> stack;
+        stack.emplace_back(&node, std::move(state));
+
+        while (!stack.empty()) {
+            auto [el, el_state] = std::move(stack.back());
+            stack.pop_back();
+            if (!visitor(*el, el_state)) continue;
+
+            // Push in reverse so that inputs are visited left to right. The first input takes over the state.
+            auto inputs = el->get_input_nodes();
+            for (auto i = inputs.size(); i-- > 1;) {
+                stack.emplace_back(&inputs[i], el_state);
+            }
+            if (!inputs.empty()) stack.emplace_back(&inputs[0], std::move(el_state));
+        }
+    }
+
+    /// Pre-order: the visitor is called before the inputs of a node and may return false to skip them.
+    /// Post-order: the visitor is called once all inputs of a node have been visited.
+    enum class VisitOrder { PreOrder, PostOrder };
+
+    /// Whether nodes with multiple parents are visited once per path leading to them or only once.
+    enum class SharedNodes { VisitEachPath, VisitOnce };
+
+    /// Stateless traversal without recursion. The visitor is called as `bool(const AbstractLQPNode&)` in pre-order
+    /// and may also return void, in which case all inputs are visited.
+    template <VisitOrder order = VisitOrder::PreOrder, SharedNodes shared = SharedNodes::VisitEachPath, typename Visitor>
+    void visit(const AbstractLQPNode& node, Visitor&& visitor) const {
+        std::vector<bool> visited(shared == SharedNodes::VisitOnce ? get_node_id_bound() : 0);
+        auto mark_visited = [&visited](const AbstractLQPNode& el) {
+            if constexpr (shared == SharedNodes::VisitEachPath) return true;
+            if (visited[el.get_id()]) return false;
+            visited[el.get_id()] = true;
+            return true;
+        };
+
+        if constexpr (order == VisitOrder::PreOrder) {
+            std::vector<CNodePtr> stack{ &node };
+            while (!stack.empty()) {
+                auto el = stack.back();
+                stack.pop_back();
+                if (!mark_visited(*el)) continue;
+
+                if constexpr (std::is_void_v<std::invoke_result_t<Visitor&, const AbstractLQPNode&>>) {
+                    visitor(*el);
+                } else {
+                    if (!visitor(*el)) continue;
+                }
+
+                auto inputs = el->get_input_nodes();
+                for (auto i = inputs.size(); i-- > 0;) stack.push_back(&inputs[i]);
+            }
+        } else {
+            // Nodes stay on the stack until their inputs are done, flagged by the second element.
+            std::vector<std::pair<CNodePtr, bool>> stack{ { &node, false } };
+            while (!stack.empty()) {
+                auto& [el, inputs_done] = stack.back();
+                if (inputs_done) {
+                    visitor(*el);
+                    stack.pop_back();
+                    continue;
+                }
+                if (!mark_visited(*el)) {
+                    stack.pop_back();
+                    continue;
+                }
+
+                inputs_done = true;
+                auto inputs = el->get_input_nodes();
+                for (auto i = inputs.size(); i-- > 0;) stack.emplace_back(&inputs[i], false);
+            }
         }
     }
 };
 
-void print_lqp(LQP& lqp) {
+inline void print_lqp(const LQP& lqp, std::ostream& stream = std::cout) {
     static auto node_name = [](const AbstractLQPNode& node) {
         switch(node.type) {
             case LQPNodeType::Join: return "Join";
@@ -145,10 +373,12 @@ void print_lqp(LQP& lqp) {
             case LQPNodeType::Projection: return "Projection";
             case LQPNodeType::StoredTable: return "StoredTable";
         }
+        throw std::logic_error("unknown node type");
     };
-    lqp.visit<int>(lqp.get_root(), [](const AbstractLQPNode& node, int& indent) {
-        std::cout << std::string(indent, ' ') << node_name(node) << std::endl;
+    lqp.visit<int>(lqp.get_root(), [&stream](const AbstractLQPNode& node, int& indent) {
+        stream << std::string(indent, ' ') << node_name(node) << '\n';
         indent += 2;
         return true;
     }, 0);
+    stream.flush();
 }
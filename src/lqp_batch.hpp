@@ -0,0 +1,258 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "lqp.hpp"
+
+/// Groups mutations of an LQP so that their bookkeeping is done once, on `commit`, rather than per mutation. Node
+/// inputs change immediately, but the parent index, subplan generations and structural hashes are updated at
+/// commit, and nodes removed in the batch are destroyed only then. The links the batch adds and removes are
+/// tracked per input, so each link is checked and indexed once however often it changes, and the ancestors of
+/// changed nodes are marked in a single walk.
+///
+/// Checks that only need the nodes themselves are done immediately, such as a parent not using a node for two
+/// inputs. Those that need the parent index are done by `commit`: removed nodes must belong to the LQP, have no
+/// parents or references left other than those of removed nodes, and the root must not be removed. If a check
+/// fails, or the batch is destroyed without commit, the LQP is rolled back to its state before the batch: inputs and
+/// root are restored and the nodes created in the batch are destroyed.
+///
+/// While a batch is open, the LQP must be mutated through the batch only, and its parent queries do not reflect the
+/// batch's changes; those of the batch do.
+class LQPMutationBatch final {
+private:
+    using CNodePtr = const AbstractLQPNode*;
+
+    struct InputChange {
+        CNodePtr parent;
+        CNodePtr old_input;
+        CNodePtr new_input;
+    };
+
+    LQP& lqp;
+    CNodePtr original_root;
+    CNodePtr root;
+    /// In order, for rollback.
+    std::vector<InputChange> changes;
+    std::vector<CNodePtr> created_nodes;
+    std::vector<CNodePtr> removed_nodes;
+    std::unordered_set<CNodePtr> removed_node_set;
+    /// Parent links added and removed by the batch, per input. A link occurs in at most one of them.
+    std::unordered_map<CNodePtr, std::vector<CNodePtr>> added_parents;
+    std::unordered_map<CNodePtr, std::vector<CNodePtr>> removed_parents;
+    bool open = true;
+
+    /// Records that `parent` uses `input` (`added`) or no longer does.
+    void record_link(CNodePtr input, CNodePtr parent, bool added) {
+        auto& opposite = (added ? removed_parents : added_parents)[input];
+        if (auto link = std::ranges::find(opposite, parent); link != opposite.end()) {
+            opposite.erase(link);
+            return;
+        }
+        (added ? added_parents : removed_parents)[input].push_back(parent);
+    }
+
+    void check_open() const {
+        if (!open) throw std::logic_error("cannot mutate LQP: batch already committed or rolled back");
+    }
+
+    /// Checks the invariants of the LQP after the batch. Returns an error message, or null.
+    [[nodiscard]] const char* validate() const {
+        if (removed_node_set.contains(root)) return "cannot remove the root";
+        // Removed nodes may only be referenced as inputs of other removed nodes.
+        std::unordered_map<CNodePtr, int> input_ref_counts;
+        for (auto node : removed_nodes) {
+            if (node->get_id() >= lqp.nodes.size() || lqp.nodes[node->get_id()].node != node) {
+                return "removed node not found in LQP";
+            }
+            for (const auto& input : node->get_input_nodes()) ++input_ref_counts[&input];
+        }
+        for (auto node : removed_nodes) {
+            auto input_ref_count = input_ref_counts.contains(node) ? input_ref_counts.at(node) : 0;
+            if (node->get_ref_count() > input_ref_count) return "removed node has non-zero reference count";
+            for (auto parent : get_parents(*node)) {
+                if (!removed_node_set.contains(parent)) return "removed node has parents";
+            }
+        }
+        return nullptr;
+    }
+
+    /// Destroys the removed nodes, each before its inputs, and marks the other inputs, which lose parents, in the
+    /// current generation. Unlike `LQP::remove_node`, does not advance the generation per node.
+    void destroy_removed_nodes() {
+        std::unordered_map<CNodePtr, int> remaining_parents;
+        for (auto node : removed_nodes) remaining_parents.emplace(node, 0);
+        for (auto node : removed_nodes) {
+            for (const auto& input : node->get_input_nodes()) {
+                if (auto entry = remaining_parents.find(&input); entry != remaining_parents.end()) ++entry->second;
+            }
+        }
+
+        // In removal order, so that ids are freed deterministically.
+        std::vector<CNodePtr> ready;
+        for (auto node = removed_nodes.rbegin(); node != removed_nodes.rend(); ++node) {
+            if (remaining_parents[*node] == 0) ready.push_back(*node);
+        }
+        while (!ready.empty()) {
+            auto node = ready.back();
+            ready.pop_back();
+            for (const auto& input : node->get_input_nodes()) {
+                lqp.node_parents.remove(input, *node);
+                if (auto entry = remaining_parents.find(&input); entry == remaining_parents.end()) {
+                    lqp.mark_changed(input);
+                } else if (--entry->second == 0) {
+                    ready.push_back(&input);
+                }
+            }
+            lqp.destroy_node(*node);
+        }
+    }
+
+public:
+    explicit LQPMutationBatch(LQP& lqp)
+            : lqp(lqp)
+            , original_root(lqp.root)
+            , root(lqp.root) {}
+
+    LQPMutationBatch(const LQPMutationBatch&) = delete;
+    LQPMutationBatch& operator=(const LQPMutationBatch&) = delete;
+
+    ~LQPMutationBatch() {
+        if (open) rollback();
+    }
+
+    /// Creates a node, see `LQP::make_node`. Its own links are indexed immediately.
+    template <typename T, typename... Args>
+    [[nodiscard]] const T& make_node(Args&&... args) {
+        check_open();
+        const auto& node = lqp.make_node<T>(std::forward<Args>(args)...);
+        created_nodes.push_back(&node);
+        return node;
+    }
+
+    /// Makes `parent` use `new_input` in place of `old_input`.
+    void replace_input(const AbstractLQPNode& parent, const AbstractLQPNode& old_input,
+                       const AbstractLQPNode& new_input) {
+        check_open();
+        for (const auto& input : parent.get_input_nodes()) {
+            if (&input == &new_input) {
+                throw std::logic_error("cannot replace input: new input is already an input of the parent");
+            }
+        }
+        lqp.get_mutable(parent).replace_input(old_input, new_input);
+        changes.push_back({ &parent, &old_input, &new_input });
+        record_link(&old_input, &parent, false);
+        record_link(&new_input, &parent, true);
+    }
+
+    /// Makes all parents of `node` use `new_node` instead, and `new_node` the root if `node` was.
+    void replace_node(const AbstractLQPNode& node, const AbstractLQPNode& new_node) {
+        for (auto parent : get_parents(node)) replace_input(*parent, node, new_node);
+        if (root == &node) set_root(new_node);
+    }
+
+    /// Substitutes a node for a new single-input node that has the old node as its input.
+    template <typename T, typename... Args>
+    const T& wrap_node_with(const AbstractLQPNode& node, Args&&... args) {
+        static_assert(std::derived_from<T, AbstractSingleInputNode>);
+        auto parents = get_parents(node);
+        const auto& new_node = make_node<T>(std::forward<Args>(args)..., node);
+        for (auto parent : parents) replace_input(*parent, node, new_node);
+        if (root == &node) set_root(new_node);
+        return new_node;
+    }
+
+    /// Connects the parents of the node to its input and removes it.
+    void bypass_node(const AbstractSingleInputNode& node) {
+        replace_node(node, node.get_input());
+        remove_node(node);
+    }
+
+    /// Destroys the node on commit. It must have no parents by then, other than nodes removed as well.
+    void remove_node(const AbstractLQPNode& node) {
+        check_open();
+        if (!removed_node_set.insert(&node).second) throw std::logic_error("cannot remove node: already removed");
+        removed_nodes.push_back(&node);
+    }
+
+    void set_root(const AbstractLQPNode& node) {
+        check_open();
+        root = &node;
+        lqp.root = const_cast<AbstractLQPNode*>(&node);
+    }
+
+    /// Parents of the node, including the changes of the batch.
+    [[nodiscard]] std::vector<CNodePtr> get_parents(const AbstractLQPNode& node) const {
+        std::vector<CNodePtr> parents;
+        const auto* removed = removed_parents.contains(&node) ? &removed_parents.at(&node) : nullptr;
+        for (const auto& [_, parent] : lqp.get_parents(node)) {
+            if (removed == nullptr || std::ranges::find(*removed, parent) == removed->end()) parents.push_back(parent);
+        }
+        if (auto added = added_parents.find(&node); added != added_parents.end()) {
+            parents.insert(parents.end(), added->second.begin(), added->second.end());
+        }
+        return parents;
+    }
+
+    [[nodiscard]] int get_parent_count(const AbstractLQPNode& node) const {
+        return static_cast<int>(get_parents(node).size());
+    }
+
+    /// Number of input changes recorded so far.
+    [[nodiscard]] std::size_t get_change_count() const { return changes.size(); }
+
+    /// Updates the parent index, marks the changed subplans in a single new generation and destroys the removed
+    /// nodes. Rolls the batch back and throws `std::logic_error` if the result violates an invariant.
+    void commit() {
+        check_open();
+        if (const auto* error = validate()) {
+            rollback();
+            throw std::logic_error(std::string("cannot commit batch: ") + error);
+        }
+        open = false;
+
+        // Parent counts before the batch of the inputs that lost links, to mark those left with fewer parents. The
+        // links of created nodes are indexed already and not counted.
+        std::unordered_set<CNodePtr> created_node_set(created_nodes.begin(), created_nodes.end());
+        std::vector<std::pair<CNodePtr, int>> parent_counts;
+        for (const auto& [input, parents] : removed_parents) {
+            if (parents.empty() || removed_node_set.contains(input)) continue;
+            auto count = 0;
+            for (const auto& [_, parent] : lqp.get_parents(*input)) count += !created_node_set.contains(parent);
+            parent_counts.emplace_back(input, count);
+        }
+
+        for (const auto& [input, parents] : removed_parents) {
+            for (auto parent : parents) lqp.node_parents.remove(*input, *parent);
+        }
+        for (const auto& [input, parents] : added_parents) {
+            for (auto parent : parents) lqp.node_parents.add(*input, *parent);
+        }
+
+        ++lqp.generation;
+        for (const auto& change : changes) lqp.mark_changed(*change.parent);
+        for (const auto& [input, count] : parent_counts) {
+            if (lqp.get_parent_count(*input) < count) lqp.mark_changed(*input);
+        }
+        lqp.root = const_cast<AbstractLQPNode*>(root);
+        destroy_removed_nodes();
+    }
+
+    /// Restores the inputs and root of the LQP and destroys the nodes created in the batch.
+    void rollback() {
+        check_open();
+        open = false;
+        for (auto change = changes.rbegin(); change != changes.rend(); ++change) {
+            lqp.get_mutable(*change->parent).replace_input(*change->new_input, *change->old_input);
+        }
+        lqp.root = const_cast<AbstractLQPNode*>(original_root);
+        // Nodes created later may use earlier ones as inputs, but not the other way around.
+        for (auto node = created_nodes.rbegin(); node != created_nodes.rend(); ++node) lqp.remove_node(**node);
+    }
+};
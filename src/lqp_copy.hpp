@@ -0,0 +1,135 @@
+#pragma once
+
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "lqp.hpp"
+#include "lqp_nodes.hpp"
+
+/// Creates a node with the type and contents of `node`, but the given inputs, by calling
+/// `make(std::type_identity<T>{}, args...)` with its type and the constructor arguments following the expression pool.
+/// The inputs must match the number of inputs of `node`.
+template <typename Make>
+const AbstractLQPNode& make_node_copy(const AbstractLQPNode& node, const LQPNodeInputs& inputs, Make&& make) {
+    if (inputs.size() != node.get_input_nodes().size()) {
+        throw std::logic_error("cannot copy node: input count mismatch");
+    }
+    switch (node.type) {
+        case LQPNodeType::StoredTable:
+            return make(std::type_identity<StoredTableNode>{}, static_cast<const StoredTableNode&>(node).get_name());
+        case LQPNodeType::Predicate:
+            return make(std::type_identity<PredicateNode>{}, static_cast<const PredicateNode&>(node).get_predicate(),
+                        inputs[0]);
+        case LQPNodeType::Join: {
+            const auto& join = static_cast<const JoinNode&>(node);
+            return make(std::type_identity<JoinNode>{}, join.get_mode(), join.get_condition(), inputs[0], inputs[1]);
+        }
+        case LQPNodeType::Projection:
+            return make(std::type_identity<ProjectionNode>{}, static_cast<const ProjectionNode&>(node).get_expressions(),
+                        inputs[0]);
+    }
+    throw std::logic_error("cannot copy node: unsupported node type");
+}
+
+/// Creates a node in `lqp` with the type and contents of `node`, but the given inputs. The inputs must belong to
+/// `lqp` and match the number of inputs of `node`.
+inline const AbstractLQPNode& copy_node(LQP& lqp, const AbstractLQPNode& node, const LQPNodeInputs& inputs) {
+    auto make_node = [&lqp]<typename T>(std::type_identity<T>, auto&&... args) -> const AbstractLQPNode& {
+        return lqp.make_node<T>(std::forward<decltype(args)>(args)...);
+    };
+    return make_node_copy(node, inputs, make_node);
+}
+
+/// Copies the subplan rooted at `root` of `source` into `lqp` bottom-up and returns the copy of `root`. Shared nodes
+/// are copied once. `copy` creates each node from the original and the copies of its inputs, like `copy_node`.
+template <typename CopyNode>
+const AbstractLQPNode& copy_subplan(LQP& lqp, const LQP& source, const AbstractLQPNode& root, CopyNode&& copy) {
+    std::vector<const AbstractLQPNode*> copies(source.get_node_id_bound());
+    source.visit<LQP::VisitOrder::PostOrder, LQP::SharedNodes::VisitOnce>(root, [&](const AbstractLQPNode& node) {
+        auto inputs = node.get_input_nodes();
+        LQPNodeInputs input_copies;
+        if (inputs.size() == 1) input_copies = LQPNodeInputs(*copies[inputs[0].get_id()]);
+        if (inputs.size() == 2) input_copies = { *copies[inputs[0].get_id()], *copies[inputs[1].get_id()] };
+        copies[node.get_id()] = &copy(lqp, node, input_copies);
+    });
+    return *copies[root.get_id()];
+}
+
+inline const AbstractLQPNode& copy_subplan(LQP& lqp, const LQP& source, const AbstractLQPNode& root) {
+    return copy_subplan(lqp, source, root, copy_node);
+}
+
+/// Makes the empty `lqp` a copy of `source`: of all its nodes, including those not reachable from the root, or of
+/// those reachable from the root only, with shared nodes copied once, parents that are copied listed in the same
+/// order and the root set to the copy of the root.
+///
+/// Unlike `copy_subplan`, the copy is made in one pass over the nodes in topological order, inputs first, which
+/// become dense ids in that order. Node memory is reserved in a single arena chunk up front, and the parent index
+/// is filled from the links of `source` without the checks of `LQP::make_node`, which are linear in the number of
+/// parents.
+inline void clone_lqp(LQP& lqp, const LQP& source, ClonedNodes cloned_nodes = ClonedNodes::All) {
+    if (lqp.get_node_count() != 0) throw std::logic_error("cannot clone LQP: target LQP not empty");
+
+    // Post-order from the root, or from the nodes without parents, which reach all nodes of the DAG. Nodes stay on
+    // the stack until their inputs are done, flagged by the second element.
+    std::vector<const AbstractLQPNode*> starts;
+    if (cloned_nodes == ClonedNodes::ReachableFromRoot) {
+        if (source.root != nullptr) starts.push_back(source.root);
+    } else {
+        for (const auto& slot : source.nodes) {
+            if (slot.node != nullptr && source.get_parent_count(*slot.node) == 0) starts.push_back(slot.node);
+        }
+    }
+    std::vector<const AbstractLQPNode*> order;
+    order.reserve(source.get_node_count());
+    std::vector<bool> visited(source.get_node_id_bound());
+    std::vector<std::pair<const AbstractLQPNode*, bool>> stack;
+    for (auto start : starts) {
+        stack.emplace_back(start, false);
+        while (!stack.empty()) {
+            auto& [node, inputs_done] = stack.back();
+            if (inputs_done) {
+                order.push_back(node);
+                stack.pop_back();
+                continue;
+            }
+            if (visited[node->get_id()]) {
+                stack.pop_back();
+                continue;
+            }
+            visited[node->get_id()] = true;
+            inputs_done = true;
+            auto inputs = node->get_input_nodes();
+            for (auto i = inputs.size(); i-- > 0;) stack.emplace_back(&inputs[i], false);
+        }
+    }
+    std::size_t memory = 0;
+    for (auto node : order) memory += utils::Arena::get_block_size(source.nodes[node->get_id()].size);
+    lqp.arena.reserve(memory);
+    lqp.nodes.reserve(lqp.nodes.size() + order.size());
+
+    auto create_node = [&lqp]<typename T>(std::type_identity<T>, auto&&... args) -> const AbstractLQPNode& {
+        return lqp.create_node<T>(std::forward<decltype(args)>(args)...);
+    };
+
+    std::vector<const AbstractLQPNode*> copies(source.get_node_id_bound());
+    for (auto node : order) {
+        auto inputs = node->get_input_nodes();
+        LQPNodeInputs input_copies;
+        if (inputs.size() == 1) input_copies = LQPNodeInputs(*copies[inputs[0].get_id()]);
+        if (inputs.size() == 2) input_copies = { *copies[inputs[0].get_id()], *copies[inputs[1].get_id()] };
+        copies[node->get_id()] = &make_node_copy(*node, input_copies, create_node);
+    }
+
+    lqp.node_parents.reserve(lqp.get_node_id_bound());
+    for (auto node : order) {
+        for (const auto& [_, parent] : source.get_parents(*node)) {
+            if (const auto* parent_copy = copies[parent->get_id()]) {
+                lqp.node_parents.append(*copies[node->get_id()], *parent_copy);
+            }
+        }
+    }
+    if (source.root != nullptr) lqp.set_root(*copies[source.root->get_id()]);
+}
@@ -1,6 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "abstract_lqp_node.hpp"
+#include "expression_parser.hpp"
 
 class StoredTableNode final : public AbstractLeafNode {
 private:
@@ -9,31 +16,165 @@ public:
     explicit StoredTableNode(std::string name)
             : AbstractLeafNode(LQPNodeType::StoredTable)
             , name(std::move(name)) {}
+
+    [[nodiscard]] const std::string& get_name() const { return name; }
+
+    [[nodiscard]] std::size_t shallow_hash() const override { return std::hash<std::string>()(name); }
+
+    [[nodiscard]] bool shallow_equals(const AbstractLQPNode& other) const override {
+        return name == static_cast<const StoredTableNode&>(other).name;
+    }
 };
 
 class PredicateNode final : public AbstractSingleInputNode {
 private:
-    std::string predicate;
+    const AbstractExpression* predicate;
 public:
-    explicit PredicateNode(std::string predicate, const AbstractLQPNode& input)
+    /// Imports the predicate into the pool of the LQP, in constant time if it belongs to that pool already.
+    PredicateNode(ExpressionPool& pool, const AbstractExpression& predicate, const AbstractLQPNode& input)
             : AbstractSingleInputNode(LQPNodeType::Predicate, input)
-            , predicate(std::move(predicate)) {}
+            , predicate(&pool.import(predicate)) {}
+
+    /// Parses the predicate, see `ExpressionParser`.
+    PredicateNode(ExpressionPool& pool, std::string_view predicate, const AbstractLQPNode& input)
+            : PredicateNode(pool, parse_expression(pool, predicate), input) {}
+
+    [[nodiscard]] const AbstractExpression& get_predicate() const { return *predicate; }
+
+    /// Text form of the predicate, built on each call.
+    [[nodiscard]] std::string get_predicate_string() const { return to_string(*predicate); }
+
+    [[nodiscard]] std::size_t shallow_hash() const override { return predicate->get_hash(); }
+
+    /// Constant time for nodes of the same LQP, whose predicates are interned in the same pool.
+    [[nodiscard]] bool shallow_equals(const AbstractLQPNode& other) const override {
+        const auto* other_predicate = static_cast<const PredicateNode&>(other).predicate;
+        return predicate == other_predicate || expressions_equal(*predicate, *other_predicate);
+    }
 };
 
+/// Outputs the given expressions for each input row. Columns not referenced by the expressions are not output.
+class ProjectionNode final : public AbstractSingleInputNode {
+private:
+    std::vector<const AbstractExpression*> expressions;
+public:
+    /// Imports the expressions into the pool of the LQP, see `PredicateNode`.
+    ProjectionNode(ExpressionPool& pool, std::span<const AbstractExpression* const> expressions,
+                   const AbstractLQPNode& input)
+            : AbstractSingleInputNode(LQPNodeType::Projection, input) {
+        this->expressions.reserve(expressions.size());
+        for (const auto* expression : expressions) this->expressions.push_back(&pool.import(*expression));
+    }
+
+    /// Parses a comma-separated list of expressions, such as `tbl_a.x, tbl_a.y + 1`.
+    ProjectionNode(ExpressionPool& pool, std::string_view expressions, const AbstractLQPNode& input)
+            : ProjectionNode(pool, parse_expression_list(pool, expressions), input) {}
+
+    [[nodiscard]] std::span<const AbstractExpression* const> get_expressions() const { return expressions; }
+
+    /// Text form of the expressions, comma-separated, built on each call.
+    [[nodiscard]] std::string get_expressions_string() const {
+        std::string result;
+        for (const auto* expression : expressions) {
+            if (!result.empty()) result.append(", ");
+            result.append(to_string(*expression));
+        }
+        return result;
+    }
+
+    [[nodiscard]] std::size_t shallow_hash() const override {
+        auto hash = expressions.size();
+        for (const auto* expression : expressions) utils::hash_combine(hash, expression->get_hash());
+        return hash;
+    }
+
+    [[nodiscard]] bool shallow_equals(const AbstractLQPNode& other) const override {
+        const auto& other_expressions = static_cast<const ProjectionNode&>(other).expressions;
+        return std::ranges::equal(expressions, other_expressions, [](const auto* lhs, const auto* rhs) {
+            return lhs == rhs || expressions_equal(*lhs, *rhs);
+        });
+    }
+};
+
+enum class JoinMode {
+    Inner,
+    /// Left outer join: left rows without a match are output once, with nulls for the right columns.
+    Left,
+    /// Left rows with a match, output once and with the left columns only.
+    Semi,
+    /// Left rows without a match, with the left columns only.
+    Anti
+};
+
+[[nodiscard]] constexpr std::string_view get_join_mode_name(JoinMode mode) {
+    switch (mode) {
+        case JoinMode::Inner: return "Inner";
+        case JoinMode::Left: return "Left";
+        case JoinMode::Semi: return "Semi";
+        case JoinMode::Anti: return "Anti";
+    }
+    return "";
+}
+
+/// Joins the rows of its inputs for which the condition holds. Joins without a condition are cross products.
+///
+/// The conjuncts of the condition that compare a column to another column for equality are the equi conditions,
+/// which can serve as keys of a hash join. The other conjuncts are theta conditions, evaluated on each candidate
+/// pair of rows.
 class JoinNode final : public AbstractLQPNode {
 private:
     LQPNodeRef left_input;
     LQPNodeRef right_input;
+    JoinMode mode = JoinMode::Inner;
+    /// Null for cross products.
+    const AbstractExpression* condition = nullptr;
 public:
+    /// Inner join without a condition.
     explicit JoinNode(const AbstractLQPNode& left_input, const AbstractLQPNode& right_input)
             : AbstractLQPNode(LQPNodeType::Join)
             , left_input(left_input.get_node_ref())
             , right_input(right_input.get_node_ref()) {}
 
-    [[nodiscard]] LQPNodeVector get_inputs() const override { return {
-                std::ref(left_input.get_node()),
-                std::ref(right_input.get_node())
-        }; };
+    /// Imports the condition, if any, into the pool of the LQP, see `PredicateNode`.
+    JoinNode(ExpressionPool& pool, JoinMode mode, const AbstractExpression* condition,
+             const AbstractLQPNode& left_input, const AbstractLQPNode& right_input)
+            : JoinNode(left_input, right_input) {
+        this->mode = mode;
+        if (condition != nullptr) this->condition = &pool.import(*condition);
+    }
+
+    /// Parses the condition, see `ExpressionParser`.
+    JoinNode(ExpressionPool& pool, JoinMode mode, std::string_view condition,
+             const AbstractLQPNode& left_input, const AbstractLQPNode& right_input)
+            : JoinNode(pool, mode, &parse_expression(pool, condition), left_input, right_input) {}
+
+    [[nodiscard]] JoinMode get_mode() const { return mode; }
+
+    [[nodiscard]] const AbstractExpression* get_condition() const { return condition; }
+
+    /// Column equalities among the conjuncts of the condition.
+    [[nodiscard]] std::vector<const BinaryExpression*> get_equi_conditions() const {
+        std::vector<const BinaryExpression*> equi_conditions;
+        if (condition == nullptr) return equi_conditions;
+        for (const auto* conjunct : get_conjuncts(*condition)) {
+            if (is_column_equality(*conjunct)) equi_conditions.push_back(static_cast<const BinaryExpression*>(conjunct));
+        }
+        return equi_conditions;
+    }
+
+    /// Conjuncts of the condition that are not column equalities.
+    [[nodiscard]] std::vector<const AbstractExpression*> get_theta_conditions() const {
+        std::vector<const AbstractExpression*> theta_conditions;
+        if (condition == nullptr) return theta_conditions;
+        for (const auto* conjunct : get_conjuncts(*condition)) {
+            if (!is_column_equality(*conjunct)) theta_conditions.push_back(conjunct);
+        }
+        return theta_conditions;
+    }
+
+    [[nodiscard]] LQPNodeInputs get_input_nodes() const override {
+        return { left_input.get_node(), right_input.get_node() };
+    }
 
     void replace_input(const AbstractLQPNode &old_input, const AbstractLQPNode &new_input) override {
         if (&old_input == &left_input.get_node()) {
@@ -46,4 +187,18 @@ public:
         }
         throw std::logic_error("cannot replace input: input not found");
     }
+
+    [[nodiscard]] std::size_t shallow_hash() const override {
+        auto hash = static_cast<std::size_t>(mode);
+        if (condition != nullptr) utils::hash_combine(hash, condition->get_hash());
+        return hash;
+    }
+
+    [[nodiscard]] bool shallow_equals(const AbstractLQPNode& other) const override {
+        const auto& other_join = static_cast<const JoinNode&>(other);
+        if (mode != other_join.mode) return false;
+        if (condition == other_join.condition) return true;
+        return condition != nullptr && other_join.condition != nullptr
+               && expressions_equal(*condition, *other_join.condition);
+    }
 };
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "lqp.hpp"
+#include "lqp_copy.hpp"
+
+/// Immutable copy of the plan of an LQP at one generation, for readers on other threads such as monitoring or cost
+/// estimation. The copy has its own nodes and expressions, so the source LQP may be mutated or destroyed meanwhile.
+/// Only the nodes reachable from the root are copied, so nodes left over from rewrites are neither copied nor
+/// reachable through the parents of copied nodes.
+///
+/// The caches that const access fills lazily, structural hashes of nodes and hashes of expressions, are filled on
+/// construction for all nodes of the copy, so that any number of threads may read a snapshot without locks:
+/// traverse it, query parents, hash and compare subplans, estimate costs. Taking `LQPNodeRef`s to its nodes is not
+/// thread-safe, as reference counts are plain integers.
+class LQPSnapshot final {
+private:
+    LQP lqp;
+    std::uint64_t generation;
+
+public:
+    /// Copies the nodes of `source` reachable from its root, see `clone_lqp`. Its root must be set.
+    explicit LQPSnapshot(const LQP& source) : generation(source.get_generation()) {
+        clone_lqp(lqp, source, ClonedNodes::ReachableFromRoot);
+        // Computes and caches the hashes of all nodes, as all are reachable from the root.
+        static_cast<void>(lqp.get_root().get_structural_hash());
+    }
+
+    LQPSnapshot(const LQPSnapshot&) = delete;
+    LQPSnapshot& operator=(const LQPSnapshot&) = delete;
+
+    [[nodiscard]] const LQP& get_lqp() const { return lqp; }
+
+    [[nodiscard]] const AbstractLQPNode& get_root() const { return lqp.get_root(); }
+
+    /// Generation of the source LQP the snapshot was taken at.
+    [[nodiscard]] std::uint64_t get_generation() const { return generation; }
+};
+
+/// Publishes snapshots of an LQP to concurrent readers, copying the plan only when it changed.
+///
+/// The owner of the LQP calls `publish` at points where the plan is consistent, such as after each optimizer rule.
+/// If the LQP is still at the generation of the last snapshot, the snapshot is kept, so it is shared by all readers
+/// until the next mutation. Readers call `get` from any thread and keep the snapshot alive as long as they hold it;
+/// publishing a new snapshot does not affect them. Only handing out the pointer is locked, reading snapshots is not.
+class LQPSnapshotPublisher final {
+private:
+    const LQP& lqp;
+    /// Guards `snapshot`. Held only to copy or replace the pointer.
+    mutable std::mutex mutex;
+    std::shared_ptr<const LQPSnapshot> snapshot;
+
+public:
+    explicit LQPSnapshotPublisher(const LQP& lqp) : lqp(lqp) {}
+
+    /// Takes a snapshot of the LQP unless the current one is up to date, and returns it. Must be called from the
+    /// thread mutating the LQP.
+    std::shared_ptr<const LQPSnapshot> publish() {
+        // Only this thread replaces the snapshot, so it can be read without the lock.
+        if (snapshot != nullptr && snapshot->get_generation() == lqp.get_generation()) return snapshot;
+        auto previous = std::make_shared<const LQPSnapshot>(lqp);
+        {
+            std::scoped_lock lock(mutex);
+            snapshot.swap(previous);
+        }
+        // The previous snapshot is destroyed here if no reader holds it, outside the lock.
+        return snapshot;
+    }
+
+    /// Latest published snapshot, or null if none was published yet. Thread-safe.
+    [[nodiscard]] std::shared_ptr<const LQPSnapshot> get() const {
+        std::scoped_lock lock(mutex);
+        return snapshot;
+    }
+};
@@ -1,30 +1,35 @@
 #include "lqp.hpp"
 #include "lqp_nodes.hpp"
+#include "optimizer.hpp"
+#include "predicate_pushdown.hpp"
 
 int main() {
     // Step 1: create a simple LQP.
     //
     // [0] [Predicate]
-    //  \_[1] [Join]
-    //     \_ [3] [StoredTable]
-    //     \_ [4] [StoredTable]
+    //  \_[1] [Predicate]
+    //     \_[2] [Join]
+    //        \_ [3] [StoredTable]
+    //        \_ [4] [StoredTable]
 
     // TODO: create an LQP builder to add a "root exists" invariant to LQP?
     LQP lqp;
-    const auto& tbl_a_node = lqp.make_node<StoredTableNode>("tbl_a");
-    lqp.set_root(lqp.make_node<PredicateNode>("some predicate",
-        lqp.make_node<JoinNode>(
-            tbl_a_node,
-            lqp.make_node<StoredTableNode>("tbl_b")
+    lqp.set_root(lqp.make_node<PredicateNode>("tbl_a.x > 1",
+        lqp.make_node<PredicateNode>("tbl_b.y < 2",
+            lqp.make_node<JoinNode>(
+                lqp.make_node<StoredTableNode>("tbl_a"),
+                lqp.make_node<StoredTableNode>("tbl_b")
+            )
         )
     ));
     print_lqp(lqp);
 
     // Step 2: apply predicate pushdown.
-    const auto& new_pred = lqp.wrap_node_with<PredicateNode>(tbl_a_node, "some predicate lower down");
-    print_lqp(lqp);
-    lqp.bypass_node(new_pred);
-    // TODO
+    Optimizer optimizer;
+    RuleBatch batch{ "Pushdown" };
+    batch.rules.push_back(std::make_unique<PredicatePushdownRule>());
+    optimizer.add_batch(std::move(batch));
+    optimizer.optimize(lqp);
 
     // Step 3: verify LQP.
     //
@@ -34,7 +39,16 @@ int main() {
     //  \_[3] [Predicate]
     //     \_[4] [StoredTable]
     print_lqp(lqp);
-    // TODO
+
+    LQP expected_lqp;
+    expected_lqp.set_root(expected_lqp.make_node<JoinNode>(
+        expected_lqp.make_node<PredicateNode>("tbl_a.x > 1", expected_lqp.make_node<StoredTableNode>("tbl_a")),
+        expected_lqp.make_node<PredicateNode>("tbl_b.y < 2", expected_lqp.make_node<StoredTableNode>("tbl_b"))
+    ));
+    if (!structurally_equal(lqp.get_root(), expected_lqp.get_root())) {
+        std::cerr << "unexpected LQP after predicate pushdown" << std::endl;
+        return 1;
+    }
 
     return 0;
 }
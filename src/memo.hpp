@@ -0,0 +1,401 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "cost_model.hpp"
+#include "lqp.hpp"
+#include "lqp_copy.hpp"
+#include "lqp_nodes.hpp"
+
+using GroupId = std::uint32_t;
+using ExpressionId = std::uint32_t;
+
+class Memo;
+
+/// Adds expressions that are logically equivalent to a given one to the memo, see `Memo::explore`.
+class AbstractTransformationRule {
+public:
+    virtual ~AbstractTransformationRule() = default;
+
+    [[nodiscard]] virtual std::string_view name() const = 0;
+
+    virtual void apply(Memo& memo, ExpressionId expression) = 0;
+};
+
+/// Compact representation of many alternative plans, as in the Cascades optimizer framework. Logically equivalent
+/// expressions form a group, and the inputs of an expression are groups rather than nodes, so that every
+/// combination of alternatives for the inputs is represented without being built.
+///
+/// The operator of each expression is a node of an LQP owned by the memo, whose inputs are the representatives of
+/// the input groups: the nodes of the first expressions of these groups. Expressions are deduplicated by operator,
+/// using `shallow_hash` and `shallow_equals`, and input groups, which makes identical subplans share groups just like
+/// structural hashing does for full plans.
+///
+/// Adding an expression to a group while it exists in another group proves the two groups equivalent, and they are
+/// merged. Merged groups keep their ids, which resolve to the surviving group through a union-find structure.
+class Memo final {
+public:
+    static constexpr GroupId no_group = std::numeric_limits<GroupId>::max();
+    static constexpr std::size_t default_max_expressions = 100'000;
+
+    struct Expression {
+        const AbstractLQPNode* node;
+        GroupId group;
+        std::array<GroupId, LQPNodeInputs::max_inputs> inputs;
+        std::size_t input_count;
+        /// Set for duplicates found when merging groups.
+        bool removed = false;
+
+        [[nodiscard]] LQPNodeType get_type() const { return node->type; }
+    };
+
+private:
+    struct Group {
+        std::vector<ExpressionId> expressions;
+        /// Expressions with the group as input, possibly including removed ones.
+        std::vector<ExpressionId> users;
+        /// Names of the stored tables of the group, sorted.
+        std::vector<std::string> tables;
+    };
+
+    /// Input group sizes of an expression when the rules were last applied to it.
+    using InputGroupSizes = std::array<std::size_t, LQPNodeInputs::max_inputs>;
+
+    struct ExpressionHash {
+        const Memo* memo;
+
+        [[nodiscard]] std::size_t operator()(ExpressionId id) const {
+            const auto& expression = memo->expressions[id];
+            auto seed = expression.node->shallow_hash();
+            utils::hash_combine(seed, static_cast<std::size_t>(expression.node->type));
+            for (std::size_t i = 0; i < expression.input_count; ++i) {
+                utils::hash_combine(seed, memo->find(expression.inputs[i]));
+            }
+            return seed;
+        }
+    };
+
+    struct ExpressionEqual {
+        const Memo* memo;
+
+        [[nodiscard]] bool operator()(ExpressionId lhs_id, ExpressionId rhs_id) const {
+            const auto& lhs = memo->expressions[lhs_id];
+            const auto& rhs = memo->expressions[rhs_id];
+            if (lhs.node->type != rhs.node->type || lhs.input_count != rhs.input_count) return false;
+            for (std::size_t i = 0; i < lhs.input_count; ++i) {
+                if (memo->find(lhs.inputs[i]) != memo->find(rhs.inputs[i])) return false;
+            }
+            return lhs.node->shallow_equals(*rhs.node);
+        }
+    };
+
+    LQP lqp;
+    /// Holds the operators of expressions added by rules until they are found to be new, see `add_expression`.
+    LQP prototypes;
+    std::array<const AbstractLQPNode*, LQPNodeInputs::max_inputs> placeholders;
+    std::vector<Expression> expressions;
+    std::vector<Group> groups;
+    /// Union-find forest of merged groups.
+    mutable std::vector<GroupId> group_parents;
+    std::unordered_set<ExpressionId, ExpressionHash, ExpressionEqual> expression_index;
+    std::vector<std::optional<InputGroupSizes>> explored_input_sizes;
+
+    [[nodiscard]] LQPNodeInputs get_representative_inputs(std::span<const GroupId> inputs) const {
+        switch (inputs.size()) {
+            case 0: return {};
+            case 1: return LQPNodeInputs(get_representative(inputs[0]));
+            case 2:
+                if (find(inputs[0]) == find(inputs[1])) {
+                    throw std::logic_error("cannot add expression: input group used twice");
+                }
+                return { get_representative(inputs[0]), get_representative(inputs[1]) };
+        }
+        throw std::logic_error("cannot add expression: too many inputs");
+    }
+
+    /// Merges equivalent groups. Expressions using the merged group as input are hashed by their input groups, so
+    /// they are taken out of the index before the merge and put back afterwards. Some of them may turn out as
+    /// duplicates of other expressions then, which in turn proves their groups equivalent.
+    void merge_groups(GroupId first, GroupId second) {
+        std::vector<std::pair<GroupId, GroupId>> pending{ { first, second } };
+        while (!pending.empty()) {
+            auto [survivor, merged] = pending.back();
+            pending.pop_back();
+            survivor = find(survivor);
+            merged = find(merged);
+            if (survivor == merged) continue;
+            if (merged < survivor) std::swap(survivor, merged);
+
+            auto users = std::move(groups[merged].users);
+            for (auto id : users) {
+                if (auto it = expression_index.find(id); it != expression_index.end() && *it == id) {
+                    expression_index.erase(it);
+                }
+            }
+
+            group_parents[merged] = survivor;
+            auto& survivor_group = groups[survivor];
+            for (auto id : groups[merged].expressions) {
+                expressions[id].group = survivor;
+                survivor_group.expressions.push_back(id);
+            }
+            groups[merged].expressions.clear();
+            survivor_group.users.insert(survivor_group.users.end(), users.begin(), users.end());
+
+            for (auto id : users) {
+                if (expressions[id].removed) continue;
+                auto [existing, inserted] = expression_index.insert(id);
+                if (inserted || *existing == id) continue;
+                auto existing_group = find(expressions[*existing].group);
+                auto group = find(expressions[id].group);
+                if (existing_group != group) {
+                    pending.emplace_back(existing_group, group);
+                } else {
+                    expressions[id].removed = true;
+                    std::erase(groups[group].expressions, id);
+                }
+            }
+        }
+    }
+
+    /// Adds the expression with the operator of `node` and the given input groups, unless it exists already, see
+    /// `Memo`. Only the operator of `node` is used, so it may belong to any LQP; it is copied into the memo's LQP
+    /// if the expression is new.
+    GroupId insert_expression(const AbstractLQPNode& node, std::span<const GroupId> inputs, std::optional<GroupId> group) {
+        if (inputs.size() != node.get_input_nodes().size()) {
+            throw std::logic_error("cannot add expression: input count mismatch");
+        }
+        Expression expression{ &node, no_group, {}, inputs.size() };
+        std::ranges::copy(inputs, expression.inputs.begin());
+
+        auto id = static_cast<ExpressionId>(expressions.size());
+        expressions.push_back(expression);
+        if (auto existing = expression_index.find(id); existing != expression_index.end()) {
+            expressions.pop_back();
+            auto existing_group = expressions[*existing].group;
+            if (group) merge_groups(*group, existing_group);
+            return find(existing_group);
+        }
+        try {
+            expressions.back().node = &copy_node(lqp, node, get_representative_inputs(inputs));
+        } catch (...) {
+            expressions.pop_back();
+            throw;
+        }
+
+        if (group) {
+            group = find(*group);
+        } else {
+            group = static_cast<GroupId>(groups.size());
+            group_parents.push_back(*group);
+            auto& tables = groups.emplace_back().tables;
+            if (node.type == LQPNodeType::StoredTable) tables.push_back(static_cast<const StoredTableNode&>(node).get_name());
+            for (auto input : inputs) {
+                const auto& input_tables = groups[find(input)].tables;
+                tables.insert(tables.end(), input_tables.begin(), input_tables.end());
+            }
+            std::ranges::sort(tables);
+            tables.erase(std::unique(tables.begin(), tables.end()), tables.end());
+        }
+        expressions.back().group = *group;
+        groups[*group].expressions.push_back(id);
+        for (auto input : inputs) groups[find(input)].users.push_back(id);
+        expression_index.insert(id);
+        return *group;
+    }
+
+public:
+    Memo()
+            : placeholders{ &prototypes.make_node<StoredTableNode>("placeholder_0"),
+                            &prototypes.make_node<StoredTableNode>("placeholder_1") }
+            , expression_index(0, ExpressionHash{ this }, ExpressionEqual{ this }) {}
+    Memo(const Memo&) = delete;
+    Memo& operator=(const Memo&) = delete;
+
+    /// The group a group was merged into, or the group itself.
+    [[nodiscard]] GroupId find(GroupId group) const {
+        while (group_parents[group] != group) {
+            group_parents[group] = group_parents[group_parents[group]];
+            group = group_parents[group];
+        }
+        return group;
+    }
+
+    /// Number of groups, including those merged into others.
+    [[nodiscard]] std::size_t get_group_count() const { return groups.size(); }
+
+    /// Number of groups not merged into others.
+    [[nodiscard]] std::size_t get_distinct_group_count() const {
+        std::size_t count = 0;
+        for (GroupId group = 0; group < groups.size(); ++group) count += find(group) == group;
+        return count;
+    }
+
+    [[nodiscard]] std::size_t get_expression_count() const { return expressions.size(); }
+
+    /// The expression with its group and input groups resolved to the groups they were merged into.
+    [[nodiscard]] Expression get_expression(ExpressionId id) const {
+        auto expression = expressions[id];
+        expression.group = find(expression.group);
+        for (std::size_t i = 0; i < expression.input_count; ++i) expression.inputs[i] = find(expression.inputs[i]);
+        return expression;
+    }
+
+    /// The reference is invalidated by adding expressions.
+    [[nodiscard]] const std::vector<ExpressionId>& get_group_expressions(GroupId group) const {
+        return groups[find(group)].expressions;
+    }
+
+    /// Names of the stored tables below the group, sorted.
+    [[nodiscard]] const std::vector<std::string>& get_tables(GroupId group) const { return groups[find(group)].tables; }
+
+    /// Pool of the expressions of the memo's operators, for rules building new expressions from them.
+    [[nodiscard]] ExpressionPool& get_expression_pool() { return lqp.get_expression_pool(); }
+
+    [[nodiscard]] const AbstractLQPNode& get_representative(GroupId group) const {
+        return *expressions[get_group_expressions(group).front()].node;
+    }
+
+    /// Adds the subplan rooted at `root` and returns the group of `root`.
+    GroupId add_plan(const LQP& source, const AbstractLQPNode& root) {
+        std::vector<GroupId> node_groups(source.get_node_id_bound(), no_group);
+        source.visit<LQP::VisitOrder::PostOrder, LQP::SharedNodes::VisitOnce>(root, [&](const AbstractLQPNode& node) {
+            std::array<GroupId, LQPNodeInputs::max_inputs> inputs{};
+            std::size_t input_count = 0;
+            for (const auto& input : node.get_input_nodes()) inputs[input_count++] = node_groups[input.get_id()];
+            node_groups[node.get_id()] = insert_expression(node, { inputs.data(), input_count }, std::nullopt);
+        });
+        return node_groups[root.get_id()];
+    }
+
+    /// Adds the expression `T(args..., inputs...)` to `group`, or to a new group if none is given, and returns the
+    /// group the expression ends up in. Called by transformation rules.
+    template <typename T, std::size_t InputCount, typename... Args>
+    GroupId add_expression(std::optional<GroupId> group, const std::array<GroupId, InputCount>& inputs, Args&&... args) {
+        // The operator is created with placeholder inputs first, so that no node is added to the memo's LQP for
+        // expressions that exist already.
+        const auto& prototype = [&]<std::size_t... I>(std::index_sequence<I...>) -> const AbstractLQPNode& {
+            return prototypes.make_node<T>(std::forward<Args>(args)..., *placeholders[I]...);
+        }(std::make_index_sequence<InputCount>());
+        try {
+            auto result = insert_expression(prototype, inputs, group);
+            prototypes.remove_node(prototype);
+            return result;
+        } catch (...) {
+            prototypes.remove_node(prototype);
+            throw;
+        }
+    }
+
+    /// Applies the rules to every expression until no rule adds anything new, or until the memo holds
+    /// `max_expressions`. Rules may match on the expressions of input groups, so an expression is visited again
+    /// when its input groups have grown since its last visit.
+    void explore(const std::vector<std::unique_ptr<AbstractTransformationRule>>& rules,
+                 std::size_t max_expressions = default_max_expressions) {
+        for (auto changed = true; changed;) {
+            changed = false;
+            for (ExpressionId id = 0; id < expressions.size() && expressions.size() < max_expressions; ++id) {
+                if (expressions[id].removed) continue;
+                InputGroupSizes input_sizes{};
+                for (std::size_t i = 0; i < expressions[id].input_count; ++i) {
+                    input_sizes[i] = get_group_expressions(expressions[id].inputs[i]).size();
+                }
+                if (explored_input_sizes.size() <= id) explored_input_sizes.resize(id + 1);
+                if (explored_input_sizes[id] == input_sizes) continue;
+
+                explored_input_sizes[id] = input_sizes;
+                changed = true;
+                for (const auto& rule : rules) rule->apply(*this, id);
+            }
+        }
+    }
+
+    /// Builds the cheapest plan of `group` in `target`, makes it the root of `target` and returns its cost. Groups
+    /// used several times are built once and shared.
+    double extract(GroupId group, AbstractCostModel& cost_model, LQP& target) {
+        struct Best {
+            double cost = std::numeric_limits<double>::infinity();
+            ExpressionId expression = 0;
+            bool inputs_pushed = false;
+            bool done = false;
+        };
+        std::vector<Best> best(groups.size());
+        group = find(group);
+
+        // Cost the groups bottom-up. An expression with an input that is not costed yet would be part of a cycle,
+        // which equivalent groups cannot form, and is skipped.
+        std::vector<GroupId> stack{ group };
+        while (!stack.empty()) {
+            auto current = stack.back();
+            auto& current_best = best[current];
+            if (current_best.done) {
+                stack.pop_back();
+                continue;
+            }
+            if (!current_best.inputs_pushed) {
+                current_best.inputs_pushed = true;
+                for (auto id : groups[current].expressions) {
+                    auto expression = get_expression(id);
+                    for (std::size_t i = 0; i < expression.input_count; ++i) {
+                        if (!best[expression.inputs[i]].inputs_pushed) stack.push_back(expression.inputs[i]);
+                    }
+                }
+                continue;
+            }
+            for (auto id : groups[current].expressions) {
+                auto expression = get_expression(id);
+                if (expression.input_count == 2 && expression.inputs[0] == expression.inputs[1]) continue;
+                auto cost = cost_model.estimate_operator_cost(lqp, *expression.node);
+                for (std::size_t i = 0; i < expression.input_count; ++i) {
+                    const auto& input_best = best[expression.inputs[i]];
+                    cost = input_best.done ? cost + input_best.cost : std::numeric_limits<double>::infinity();
+                }
+                if (cost < current_best.cost) {
+                    current_best.cost = cost;
+                    current_best.expression = id;
+                }
+            }
+            current_best.done = true;
+            stack.pop_back();
+        }
+        if (best[group].cost == std::numeric_limits<double>::infinity()) {
+            throw std::logic_error("cannot extract plan: no finite cost");
+        }
+
+        // Build the chosen expressions bottom-up.
+        std::vector<const AbstractLQPNode*> built(groups.size());
+        std::vector<std::pair<GroupId, bool>> build_stack{ { group, false } };
+        while (!build_stack.empty()) {
+            auto [current, inputs_done] = build_stack.back();
+            if (built[current]) {
+                build_stack.pop_back();
+                continue;
+            }
+            auto expression = get_expression(best[current].expression);
+            if (!inputs_done) {
+                build_stack.back().second = true;
+                for (auto i = expression.input_count; i-- > 0;) build_stack.emplace_back(expression.inputs[i], false);
+                continue;
+            }
+            LQPNodeInputs inputs;
+            if (expression.input_count == 1) inputs = LQPNodeInputs(*built[expression.inputs[0]]);
+            if (expression.input_count == 2) inputs = { *built[expression.inputs[0]], *built[expression.inputs[1]] };
+            built[current] = &copy_node(target, *expression.node, inputs);
+            build_stack.pop_back();
+        }
+        target.set_root(*built[group]);
+        return best[group].cost;
+    }
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "abstract_rule.hpp"
+#include "lqp.hpp"
+
+/// Rules applied together, in order, until an iteration no longer changes the plan or `max_iterations` is reached.
+struct RuleBatch {
+    explicit RuleBatch(std::string name, std::size_t max_iterations = 1)
+            : name(std::move(name))
+            , max_iterations(max_iterations) {}
+
+    std::string name;
+    std::vector<std::unique_ptr<AbstractRule>> rules;
+    std::size_t max_iterations;
+};
+
+struct OptimizerReport {
+    struct RuleStatistics {
+        std::string batch_name;
+        std::string rule_name;
+        /// Applications of the rule, not counting those skipped because the plan did not change since.
+        std::size_t applications = 0;
+        std::size_t skipped = 0;
+        /// Applications that changed the plan.
+        std::size_t changes = 0;
+        std::chrono::nanoseconds duration{ 0 };
+    };
+
+    struct BatchStatistics {
+        std::string name;
+        std::size_t iterations = 0;
+        bool reached_fixpoint = false;
+    };
+
+    std::vector<BatchStatistics> batches;
+    /// In order of the batches and of the rules within them.
+    std::vector<RuleStatistics> rules;
+    std::chrono::nanoseconds duration{ 0 };
+};
+
+/// Runs ordered batches of rules over an LQP.
+class Optimizer final {
+private:
+    std::vector<RuleBatch> batches;
+
+public:
+    void add_batch(RuleBatch batch) { batches.push_back(std::move(batch)); }
+
+    OptimizerReport optimize(LQP& lqp) const {
+        using Clock = std::chrono::steady_clock;
+        auto optimizer_start = Clock::now();
+        OptimizerReport report;
+
+        for (const auto& batch : batches) {
+            auto& batch_statistics = report.batches.emplace_back(OptimizerReport::BatchStatistics{ batch.name });
+            auto first_rule = report.rules.size();
+            for (const auto& rule : batch.rules) {
+                report.rules.push_back({ batch.name, std::string(rule->name()) });
+            }
+
+            // LQP generation before the last application of each rule, passed as `since_generation` to the next one.
+            // It equals the current generation only if that application and all rules after it made no changes,
+            // in which case the rule is skipped. Zero lets the first application see all nodes.
+            std::vector<std::uint64_t> rule_generations(batch.rules.size(), 0);
+
+            while (batch_statistics.iterations < batch.max_iterations) {
+                ++batch_statistics.iterations;
+                auto iteration_generation = lqp.get_generation();
+
+                for (std::size_t i = 0; i < batch.rules.size(); ++i) {
+                    auto& statistics = report.rules[first_rule + i];
+                    if (rule_generations[i] != 0 && rule_generations[i] == lqp.get_generation()) {
+                        ++statistics.skipped;
+                        continue;
+                    }
+
+                    auto rule_start = Clock::now();
+                    auto generation_before = lqp.get_generation();
+                    batch.rules[i]->apply(lqp, rule_generations[i]);
+                    statistics.duration += Clock::now() - rule_start;
+                    ++statistics.applications;
+                    if (lqp.get_generation() != generation_before) ++statistics.changes;
+                    // A rule that changed the plan has to see its own changes, as it may apply to them again.
+                    rule_generations[i] = generation_before;
+                }
+
+                if (lqp.get_generation() == iteration_generation) {
+                    batch_statistics.reached_fixpoint = true;
+                    break;
+                }
+            }
+        }
+
+        report.duration = Clock::now() - optimizer_start;
+        return report;
+    }
+};
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <list>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "lqp.hpp"
+#include "lqp_copy.hpp"
+#include "lqp_nodes.hpp"
+#include "optimizer.hpp"
+
+/// Copy of a predicate in `pool` with its constants replaced by parameters, numbered on from the size of
+/// `parameters`. Appends the constants to `parameters`.
+[[nodiscard]] inline const AbstractExpression& parameterize_expression(ExpressionPool& pool,
+        const AbstractExpression& predicate, std::vector<const AbstractExpression*>& parameters) {
+    return pool.replace(predicate, [&](const AbstractExpression& expression) -> const AbstractExpression* {
+        if (expression.type != ExpressionType::Constant) return nullptr;
+        parameters.push_back(&expression);
+        return &pool.make<ParameterExpression>(parameters.size() - 1);
+    });
+}
+
+/// Inverse of `parameterize_expression`: copy of a predicate in `pool` with its parameters replaced by the given
+/// constants.
+[[nodiscard]] inline const AbstractExpression& bind_parameters(ExpressionPool& pool, const AbstractExpression& predicate,
+        std::span<const AbstractExpression* const> parameters) {
+    return pool.replace(predicate, [&](const AbstractExpression& expression) -> const AbstractExpression* {
+        if (expression.type != ExpressionType::Parameter) return nullptr;
+        auto index = static_cast<const ParameterExpression&>(expression).get_index();
+        if (index >= parameters.size()) throw std::logic_error("cannot bind parameters: invalid parameter");
+        return parameters[index];
+    });
+}
+
+/// Caches optimized plans for queries that differ only in their constants.
+///
+/// A query is normalized by replacing the constants of its predicates by numbered parameters, see
+/// `parameterize_expression`, and looked up by the structural hash of the normalized plan. On a miss, the normalized
+/// plan is optimized and stored. Either way, the result is the stored plan with the query's constants bound to the
+/// parameters. Cached plans are thus optimized without knowing the constants, as for prepared statements: cost-based
+/// rules see the parameters as unknown values.
+///
+/// The cache holds at most `max_node_count` nodes over all entries, evicting the least recently used ones.
+class PlanCache final {
+public:
+    static constexpr std::size_t default_max_node_count = 100'000;
+
+    struct Statistics {
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        std::size_t evictions = 0;
+    };
+
+private:
+    struct Entry {
+        /// The normalized query, the key of the entry.
+        LQP query;
+        LQP plan;
+        std::size_t node_count = 0;
+    };
+
+    const Optimizer& optimizer;
+    std::size_t max_node_count;
+    std::size_t node_count = 0;
+    /// Most recently used first.
+    std::list<Entry> entries;
+    std::unordered_map<const AbstractLQPNode*, std::list<Entry>::iterator, StructuralHash, StructuralEqual> index;
+    Statistics statistics;
+
+    void evict_until_fits(std::size_t required_node_count) {
+        while (!entries.empty() && node_count + required_node_count > max_node_count) {
+            auto& entry = entries.back();
+            index.erase(&entry.query.get_root());
+            node_count -= entry.node_count;
+            entries.pop_back();
+            ++statistics.evictions;
+        }
+    }
+
+public:
+    explicit PlanCache(const Optimizer& optimizer, std::size_t max_node_count = default_max_node_count)
+            : optimizer(optimizer)
+            , max_node_count(max_node_count) {}
+
+    /// Builds the optimized plan of `query` in `target` and makes it the root of `target`. Returns whether the plan
+    /// was served from the cache.
+    bool optimize(const LQP& query, LQP& target) {
+        std::vector<const AbstractExpression*> parameters;
+        auto parameterize = [&](LQP& lqp, const AbstractLQPNode& node, const LQPNodeInputs& inputs) -> const AbstractLQPNode& {
+            if (node.type != LQPNodeType::Predicate) return copy_node(lqp, node, inputs);
+            const auto& predicate = static_cast<const PredicateNode&>(node).get_predicate();
+            return lqp.make_node<PredicateNode>(parameterize_expression(lqp.get_expression_pool(), predicate, parameters), inputs[0]);
+        };
+        auto bind = [&](LQP& lqp, const AbstractLQPNode& node, const LQPNodeInputs& inputs) -> const AbstractLQPNode& {
+            if (node.type != LQPNodeType::Predicate) return copy_node(lqp, node, inputs);
+            const auto& predicate = static_cast<const PredicateNode&>(node).get_predicate();
+            return lqp.make_node<PredicateNode>(bind_parameters(lqp.get_expression_pool(), predicate, parameters), inputs[0]);
+        };
+
+        // The normalized query is built in a new entry, which is only kept on a miss.
+        std::list<Entry> new_entries;
+        auto& entry = new_entries.emplace_back();
+        entry.query.set_root(copy_subplan(entry.query, query, query.get_root(), parameterize));
+
+        auto hit = index.find(&entry.query.get_root());
+        auto is_hit = hit != index.end();
+        if (is_hit) {
+            ++statistics.hits;
+            entries.splice(entries.begin(), entries, hit->second);
+        } else {
+            ++statistics.misses;
+            entry.plan.set_root(copy_subplan(entry.plan, entry.query, entry.query.get_root()));
+            optimizer.optimize(entry.plan);
+            entry.node_count = entry.query.get_node_count() + entry.plan.get_node_count();
+
+            // The new entry is kept even if it exceeds the limit on its own, so that the query can be served.
+            evict_until_fits(entry.node_count);
+            node_count += entry.node_count;
+            entries.splice(entries.begin(), new_entries);
+            index.emplace(&entries.front().query.get_root(), entries.begin());
+        }
+
+        const auto& plan = entries.front().plan;
+        target.set_root(copy_subplan(target, plan, plan.get_root(), bind));
+        return is_hit;
+    }
+
+    [[nodiscard]] const Statistics& get_statistics() const { return statistics; }
+
+    [[nodiscard]] std::size_t get_entry_count() const { return entries.size(); }
+
+    /// Number of nodes held by all entries.
+    [[nodiscard]] std::size_t get_node_count() const { return node_count; }
+
+    void clear() {
+        index.clear();
+        entries.clear();
+        node_count = 0;
+    }
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "abstract_rule.hpp"
+#include "lqp.hpp"
+#include "lqp_nodes.hpp"
+
+/// Moves every predicate as far down as possible: through predicate chains and into the join input that contains
+/// all tables the predicate references. Only inner joins pass predicates to their right input. Shared subplans are
+/// not entered, as pushing a predicate into them would filter the rows seen by their other parents too.
+///
+/// Predicates are collected in a single top-down traversal and each is moved at most once, directly to its final
+/// position, using `LQP::wrap_node_with` and `LQP::bypass_node`.
+class PredicatePushdownRule final : public AbstractRule {
+private:
+    /// Bitset over the tables of the plan.
+    using TableSet = std::vector<bool>;
+
+    /// Tables beyond the size of `tables` are not contained.
+    [[nodiscard]] static bool contains_all(const TableSet& tables, const TableSet& referenced) {
+        for (std::size_t i = 0; i < referenced.size(); ++i) {
+            if (referenced[i] && (i >= tables.size() || !tables[i])) return false;
+        }
+        return true;
+    }
+
+public:
+    [[nodiscard]] std::string_view name() const override { return "PredicatePushdown"; }
+
+    void apply(LQP& lqp, std::uint64_t since_generation) override {
+        // Collect the predicates top-down, skipping subplans that did not change since the last application.
+        std::vector<const PredicateNode*> predicates;
+        lqp.visit<LQP::VisitOrder::PreOrder, LQP::SharedNodes::VisitOnce>(lqp.get_root(), [&](const AbstractLQPNode& node) {
+            if (!lqp.subplan_changed_since(node, since_generation)) return false;
+            if (node.type == LQPNodeType::Predicate) predicates.push_back(static_cast<const PredicateNode*>(&node));
+            return true;
+        });
+        if (predicates.empty()) return;
+
+        // Index the tables and compute the tables below each node, indexed by node id. Nodes created further
+        // down are assigned the tables of their input.
+        std::unordered_map<std::string, std::size_t> table_indices;
+        std::vector<TableSet> node_tables(lqp.get_node_id_bound());
+        lqp.visit<LQP::VisitOrder::PostOrder, LQP::SharedNodes::VisitOnce>(lqp.get_root(), [&](const AbstractLQPNode& node) {
+            auto& tables = node_tables[node.get_id()];
+            if (node.type == LQPNodeType::StoredTable) {
+                const auto& name = static_cast<const StoredTableNode&>(node).get_name();
+                auto table_index = table_indices.emplace(name, table_indices.size()).first->second;
+                tables.resize(table_indices.size());
+                tables[table_index] = true;
+            }
+            for (const auto& input : node.get_input_nodes()) {
+                const auto& input_tables = node_tables[input.get_id()];
+                if (tables.size() < input_tables.size()) tables.resize(input_tables.size());
+                for (std::size_t i = 0; i < input_tables.size(); ++i) {
+                    if (input_tables[i]) tables[i] = true;
+                }
+            }
+        });
+
+        for (auto predicate : predicates) {
+            TableSet referenced(table_indices.size());
+            auto table_names = get_referenced_table_names(predicate->get_predicate());
+            auto references_known_tables = !table_names.empty();
+            for (const auto& table_name : table_names) {
+                auto table_index = table_indices.find(table_name);
+                if (table_index == table_indices.end()) {
+                    references_known_tables = false;
+                    break;
+                }
+                referenced[table_index->second] = true;
+            }
+            if (!references_known_tables) continue;
+
+            // Descend through predicates and into join inputs covering the referenced tables. The predicate goes
+            // directly above the last join input entered.
+            const AbstractLQPNode* target = nullptr;
+            const AbstractLQPNode* node = &predicate->get_input().get();
+            while (lqp.get_parent_count(*node) == 1) {
+                if (node->type == LQPNodeType::Predicate) {
+                    node = &static_cast<const PredicateNode*>(node)->get_input().get();
+                    continue;
+                }
+                if (node->type != LQPNodeType::Join) break;
+
+                // Below outer, semi and anti joins, filtering the right input would change which left rows match.
+                const AbstractLQPNode* next = nullptr;
+                auto inputs = node->get_input_nodes();
+                auto input_count = static_cast<const JoinNode*>(node)->get_mode() == JoinMode::Inner ? inputs.size() : 1;
+                for (std::size_t i = 0; i < input_count; ++i) {
+                    const auto& input = inputs[i];
+                    if (lqp.get_parent_count(input) == 1 && contains_all(node_tables[input.get_id()], referenced)) {
+                        next = &input;
+                        break;
+                    }
+                }
+                if (next == nullptr) break;
+                target = node = next;
+            }
+            if (target == nullptr) continue;
+
+            const auto& pushed_predicate = lqp.wrap_node_with<PredicateNode>(*target, predicate->get_predicate());
+            if (pushed_predicate.get_id() >= node_tables.size()) node_tables.resize(pushed_predicate.get_id() + 1);
+            node_tables[pushed_predicate.get_id()] = node_tables[target->get_id()];
+            lqp.bypass_node(*predicate);
+        }
+    }
+};
@@ -3,6 +3,17 @@
 #include <algorithm>
 #include <ranges>
 #include <unordered_map>
+#include <vector>
+
+/// Interface shared by the reverse index implementations, so that they can be swapped via a template parameter.
+template <typename Index, typename T>
+concept ReverseIndex = requires(Index& index, const Index& const_index, const T& node) {
+    { const_index.get_parent_count(node) } -> std::convertible_to<int>;
+    { const_index.get_parents(node) } -> std::ranges::range;
+    index.add(node, node);
+    index.remove(node, node);
+    index.replace_input(node, node);
+};
 
 template <typename T>
 class ReverseDAGIndex final {
@@ -62,7 +73,12 @@ public:
             throw std::logic_error("cannot replace input: new node already has parents");
         }
 
+        // Inserting may rehash and invalidate the range, so collect the parents first.
+        std::vector<const T*> parents;
         for (const auto [_, parent] : get_parents(node)) {
+            parents.push_back(parent);
+        }
+        for (auto parent : parents) {
             add(new_node, *parent);
         }
         node_parents.erase(&node);
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace utils {
+
+/// Vector storing up to `N` elements inline and spilling to the heap beyond that.
+/// Restricted to trivially copyable elements, which keeps copies and moves of the inline part trivial.
+template <typename T, std::size_t N>
+class SmallVector final {
+    static_assert(std::is_trivially_copyable_v<T>);
+    static_assert(N > 0);
+
+private:
+    std::size_t count = 0;
+    /// Holds the elements while `count <= N`.
+    std::array<T, N> inline_items{};
+    /// Holds all elements while `count > N`.
+    std::vector<T> spilled_items;
+
+    [[nodiscard]] bool is_inline() const { return count <= N; }
+
+public:
+    [[nodiscard]] std::size_t size() const { return count; }
+    [[nodiscard]] bool empty() const { return count == 0; }
+
+    [[nodiscard]] T* data() { return is_inline() ? inline_items.data() : spilled_items.data(); }
+    [[nodiscard]] const T* data() const { return is_inline() ? inline_items.data() : spilled_items.data(); }
+
+    [[nodiscard]] T* begin() { return data(); }
+    [[nodiscard]] T* end() { return data() + count; }
+    [[nodiscard]] const T* begin() const { return data(); }
+    [[nodiscard]] const T* end() const { return data() + count; }
+
+    [[nodiscard]] T& operator[](std::size_t i) { return data()[i]; }
+    [[nodiscard]] const T& operator[](std::size_t i) const { return data()[i]; }
+
+    void push_back(const T& item) {
+        if (count < N) {
+            inline_items[count++] = item;
+            return;
+        }
+        if (count == N) {
+            spilled_items.assign(inline_items.begin(), inline_items.end());
+        }
+        spilled_items.push_back(item);
+        ++count;
+    }
+
+    /// Removes the element at `index`, preserving the order of the remaining elements.
+    void erase(std::size_t index) {
+        if (is_inline()) {
+            for (auto i = index + 1; i < count; ++i) inline_items[i - 1] = inline_items[i];
+            --count;
+            return;
+        }
+        spilled_items.erase(spilled_items.begin() + static_cast<std::ptrdiff_t>(index));
+        if (--count == N) {
+            std::copy(spilled_items.begin(), spilled_items.end(), inline_items.begin());
+            spilled_items.clear();
+        }
+    }
+
+    void clear() {
+        count = 0;
+        spilled_items.clear();
+    }
+};
+
+} // namespace utils
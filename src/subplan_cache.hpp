@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "abstract_lqp_node.hpp"
+#include "lqp.hpp"
+
+/// Per-node values derived from the subplan of the node, such as cardinality or cost estimates.
+///
+/// Values are stored by node id along with the subplan generation of the node, see `LQP::get_subplan_generation`.
+/// A mutation of the plan advances the subplan generation of the changed node and its ancestors only, so after a
+/// rewrite `get` recomputes exactly these and does not enter any other subplan.
+///
+/// The cache is tied to one LQP at a time and dropped when used with another one. `clear` must be called when an
+/// LQP is destroyed and a new one is created at the same address.
+template <typename T>
+class SubplanCache final {
+private:
+    struct Entry {
+        const AbstractLQPNode* node = nullptr;
+        std::uint64_t subplan_generation = 0;
+        T value{};
+    };
+
+    const LQP* cached_lqp = nullptr;
+    /// Indexed by node id.
+    std::vector<Entry> entries;
+    std::size_t computed_count = 0;
+
+public:
+    /// The up-to-date value of the node, or nullptr if it needs to be computed.
+    [[nodiscard]] const T* find(const LQP& lqp, const AbstractLQPNode& node) const {
+        if (cached_lqp != &lqp || node.get_id() >= entries.size()) return nullptr;
+        const auto& entry = entries[node.get_id()];
+        if (entry.node != &node || entry.subplan_generation != lqp.get_subplan_generation(node)) return nullptr;
+        return &entry.value;
+    }
+
+    /// Returns the value of the node, computing it and any missing values of its inputs bottom-up. `compute` is
+    /// called as `T(const AbstractLQPNode&)` and can rely on `find` returning the values of the node's inputs.
+    template <typename Compute>
+    const T& get(const LQP& lqp, const AbstractLQPNode& node, Compute&& compute) {
+        if (cached_lqp != &lqp) {
+            clear();
+            cached_lqp = &lqp;
+        }
+        if (entries.size() < lqp.get_node_id_bound()) entries.resize(lqp.get_node_id_bound());
+
+        // Post-order traversal that does not enter subplans with an up-to-date value.
+        std::vector<std::pair<const AbstractLQPNode*, bool>> stack{ { &node, false } };
+        while (!stack.empty()) {
+            auto [el, inputs_done] = stack.back();
+            if (find(lqp, *el)) {
+                stack.pop_back();
+                continue;
+            }
+            if (!inputs_done) {
+                stack.back().second = true;
+                for (const auto& input : el->get_input_nodes()) stack.emplace_back(&input, false);
+                continue;
+            }
+            auto value = compute(*el);
+            entries[el->get_id()] = { el, lqp.get_subplan_generation(*el), std::move(value) };
+            ++computed_count;
+            stack.pop_back();
+        }
+        return entries[node.get_id()].value;
+    }
+
+    /// Number of values computed so far, not counting those served from the cache.
+    [[nodiscard]] std::size_t get_computed_count() const { return computed_count; }
+
+    void clear() {
+        cached_lqp = nullptr;
+        entries.clear();
+    }
+};
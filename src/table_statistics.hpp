@@ -0,0 +1,44 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+struct ColumnStatistics {
+    double distinct_count;
+    /// Value range of numeric columns, used to interpolate the selectivity of range predicates.
+    std::optional<double> min_value = std::nullopt;
+    std::optional<double> max_value = std::nullopt;
+};
+
+struct TableStatistics {
+    double row_count;
+    std::unordered_map<std::string, ColumnStatistics> columns = {};
+
+    [[nodiscard]] const ColumnStatistics* find_column(const std::string& name) const {
+        auto column = columns.find(name);
+        return column == columns.end() ? nullptr : &column->second;
+    }
+};
+
+/// Statistics of the stored tables, by table name.
+class StatisticsCatalog final {
+private:
+    std::unordered_map<std::string, TableStatistics> tables;
+
+public:
+    void add_table(std::string name, TableStatistics statistics) {
+        tables.insert_or_assign(std::move(name), std::move(statistics));
+    }
+
+    [[nodiscard]] const TableStatistics* find_table(const std::string& name) const {
+        auto table = tables.find(name);
+        return table == tables.end() ? nullptr : &table->second;
+    }
+
+    /// Statistics of a column of a table, or null if either is unknown.
+    [[nodiscard]] const ColumnStatistics* find_column(const std::string& table_name, const std::string& column_name) const {
+        auto table = find_table(table_name);
+        return table ? table->find_column(column_name) : nullptr;
+    }
+};
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "expression_pool.hpp"
+#include "expressions.hpp"
+#include "lqp_nodes.hpp"
+#include "memo.hpp"
+
+/// Whether the expression is an inner join, the only mode whose inputs can be swapped and regrouped.
+[[nodiscard]] inline bool is_inner_join(const Memo::Expression& expression) {
+    return expression.get_type() == LQPNodeType::Join
+           && static_cast<const JoinNode&>(*expression.node).get_mode() == JoinMode::Inner;
+}
+
+/// Join(a, b) -> Join(b, a), for inner joins.
+class JoinCommutativityTransformation final : public AbstractTransformationRule {
+public:
+    [[nodiscard]] std::string_view name() const override { return "JoinCommutativity"; }
+
+    void apply(Memo& memo, ExpressionId id) override {
+        auto expression = memo.get_expression(id);
+        if (!is_inner_join(expression)) return;
+        memo.add_expression<JoinNode>(expression.group, std::array{ expression.inputs[1], expression.inputs[0] },
+                                      JoinMode::Inner, static_cast<const JoinNode&>(*expression.node).get_condition());
+    }
+};
+
+/// Join(Join(a, b), c) -> Join(a, Join(b, c)), for inner joins. Together with commutativity, this reaches all bushy
+/// join orders. The conjuncts of both join conditions that reference only tables of `b` and `c` go to the new lower
+/// join, the others to the upper one.
+class JoinAssociativityTransformation final : public AbstractTransformationRule {
+public:
+    [[nodiscard]] std::string_view name() const override { return "JoinAssociativity"; }
+
+    void apply(Memo& memo, ExpressionId id) override {
+        auto expression = memo.get_expression(id);
+        if (!is_inner_join(expression)) return;
+        auto c = expression.inputs[1];
+        const auto* condition = static_cast<const JoinNode&>(*expression.node).get_condition();
+
+        // Adding to the memo invalidates references into it, so the left input's expressions are looked up by index.
+        auto left_input = expression.inputs[0];
+        for (std::size_t i = 0; i < memo.get_group_expressions(left_input).size(); ++i) {
+            auto left = memo.get_expression(memo.get_group_expressions(left_input)[i]);
+            if (!is_inner_join(left)) continue;
+            auto a = left.inputs[0];
+            auto b = left.inputs[1];
+            if (a == c || b == c) continue;
+
+            std::vector<const AbstractExpression*> lower_conjuncts;
+            std::vector<const AbstractExpression*> upper_conjuncts;
+            for (const auto* join_condition : { static_cast<const JoinNode&>(*left.node).get_condition(), condition }) {
+                if (join_condition == nullptr) continue;
+                for (const auto* conjunct : get_conjuncts(*join_condition)) {
+                    auto referenced_tables = get_referenced_table_names(*conjunct);
+                    auto is_lower = !referenced_tables.empty() && std::ranges::all_of(referenced_tables, [&](const auto& table) {
+                        return std::ranges::binary_search(memo.get_tables(b), table)
+                               || std::ranges::binary_search(memo.get_tables(c), table);
+                    });
+                    (is_lower ? lower_conjuncts : upper_conjuncts).push_back(conjunct);
+                }
+            }
+
+            // A canonical conjunct order lets the memo recognize conditions regrouped in different ways as equal.
+            auto by_hash = [](const auto* lhs, const auto* rhs) { return lhs->get_hash() < rhs->get_hash(); };
+            std::ranges::sort(lower_conjuncts, by_hash);
+            std::ranges::sort(upper_conjuncts, by_hash);
+            auto& pool = memo.get_expression_pool();
+            auto b_c = memo.add_expression<JoinNode>(std::nullopt, std::array{ b, c }, JoinMode::Inner,
+                                                     make_conjunction(pool, lower_conjuncts));
+            if (b_c != a) {
+                memo.add_expression<JoinNode>(expression.group, std::array{ a, b_c }, JoinMode::Inner,
+                                              make_conjunction(pool, upper_conjuncts));
+            }
+        }
+    }
+};
+
+/// Predicate(p, Join(a, b)) -> Join(Predicate(p, a), b) if `p` references only tables of `a`, and likewise for `b`
+/// if the join is an inner join.
+class PredicateJoinTransposeTransformation final : public AbstractTransformationRule {
+public:
+    [[nodiscard]] std::string_view name() const override { return "PredicateJoinTranspose"; }
+
+    void apply(Memo& memo, ExpressionId id) override {
+        auto expression = memo.get_expression(id);
+        if (expression.get_type() != LQPNodeType::Predicate) return;
+        const auto& predicate = static_cast<const PredicateNode&>(*expression.node).get_predicate();
+        auto referenced_tables = get_referenced_table_names(predicate);
+        if (referenced_tables.empty()) return;
+
+        auto references_only = [&](GroupId group) {
+            const auto& tables = memo.get_tables(group);
+            return std::ranges::all_of(referenced_tables, [&](const auto& table) {
+                return std::ranges::binary_search(tables, table);
+            });
+        };
+
+        auto input = expression.inputs[0];
+        for (std::size_t i = 0; i < memo.get_group_expressions(input).size(); ++i) {
+            auto join = memo.get_expression(memo.get_group_expressions(input)[i]);
+            if (join.get_type() != LQPNodeType::Join) continue;
+            const auto& join_node = static_cast<const JoinNode&>(*join.node);
+            auto mode = join_node.get_mode();
+            const auto* condition = join_node.get_condition();
+            for (std::size_t side = 0; side < (mode == JoinMode::Inner ? 2 : 1); ++side) {
+                if (!references_only(join.inputs[side])) continue;
+                auto inputs = join.inputs;
+                inputs[side] = memo.add_expression<PredicateNode>(std::nullopt, std::array{ join.inputs[side] }, predicate);
+                if (inputs[0] != inputs[1]) {
+                    memo.add_expression<JoinNode>(expression.group, std::array{ inputs[0], inputs[1] }, mode, condition);
+                }
+            }
+        }
+    }
+};
+
+/// Predicate(p, Predicate(q, a)) -> Predicate(q, Predicate(p, a)), so that a predicate can reach a join below
+/// other predicates.
+class PredicateReorderTransformation final : public AbstractTransformationRule {
+public:
+    [[nodiscard]] std::string_view name() const override { return "PredicateReorder"; }
+
+    void apply(Memo& memo, ExpressionId id) override {
+        auto expression = memo.get_expression(id);
+        if (expression.get_type() != LQPNodeType::Predicate) return;
+        const auto& predicate = static_cast<const PredicateNode&>(*expression.node).get_predicate();
+
+        auto input = expression.inputs[0];
+        for (std::size_t i = 0; i < memo.get_group_expressions(input).size(); ++i) {
+            auto inner = memo.get_expression(memo.get_group_expressions(input)[i]);
+            if (inner.get_type() != LQPNodeType::Predicate) continue;
+            const auto& inner_predicate = static_cast<const PredicateNode&>(*inner.node).get_predicate();
+
+            auto swapped = memo.add_expression<PredicateNode>(std::nullopt, std::array{ inner.inputs[0] }, predicate);
+            memo.add_expression<PredicateNode>(expression.group, std::array{ swapped }, inner_predicate);
+        }
+    }
+};
+
+/// All transformation rules, for `Memo::explore`.
+inline std::vector<std::unique_ptr<AbstractTransformationRule>> make_default_transformation_rules() {
+    std::vector<std::unique_ptr<AbstractTransformationRule>> rules;
+    rules.push_back(std::make_unique<JoinCommutativityTransformation>());
+    rules.push_back(std::make_unique<JoinAssociativityTransformation>());
+    rules.push_back(std::make_unique<PredicateJoinTransposeTransformation>());
+    rules.push_back(std::make_unique<PredicateReorderTransformation>());
+    return rules;
+}
@@ -1,19 +1,34 @@
 #pragma once
 
+#include <cstddef>
+#include <type_traits>
 #include <utility>
 
+/// Reference counting of `LQPNodeRef` only serves consistency checks. Unless configured explicitly,
+/// it is compiled out together with assertions.
+#ifndef LQP_CHECK_REFERENCES
+#ifdef NDEBUG
+#define LQP_CHECK_REFERENCES 0
+#else
+#define LQP_CHECK_REFERENCES 1
+#endif
+#endif
+
 namespace utils {
 
-class ReferenceCounter {
+inline constexpr bool check_references = LQP_CHECK_REFERENCES;
+
+template <bool Enabled>
+class BasicReferenceCounter {
     int* _ref_count = nullptr;
 public:
-    explicit ReferenceCounter(int& ref_count) : _ref_count(&ref_count) {
+    explicit BasicReferenceCounter(int& ref_count) : _ref_count(&ref_count) {
         if (_ref_count) (*_ref_count)++;
     }
-    ~ReferenceCounter() {
+    ~BasicReferenceCounter() {
         if (_ref_count) (*_ref_count)--;
     }
-    ReferenceCounter& operator=(const ReferenceCounter& other) {
+    BasicReferenceCounter& operator=(const BasicReferenceCounter& other) {
         if (this != &other) {
             if (_ref_count) (*_ref_count)--;
             _ref_count = other._ref_count;
@@ -21,15 +36,38 @@ public:
         }
         return *this;
     }
-    ReferenceCounter& operator=(ReferenceCounter&& other) {
+    BasicReferenceCounter& operator=(BasicReferenceCounter&& other) {
         if (this != &other) {
             if (_ref_count) (*_ref_count)--;
             _ref_count = std::exchange(other._ref_count, nullptr);
         }
         return *this;
     }
-    ReferenceCounter(const ReferenceCounter& other) { *this = other; }
-    ReferenceCounter(ReferenceCounter&& other) { *this = std::move(other); }
+    BasicReferenceCounter(const BasicReferenceCounter& other) { *this = other; }
+    BasicReferenceCounter(BasicReferenceCounter&& other) { *this = std::move(other); }
+};
+
+/// Takes the place of the count when reference counting is disabled.
+struct NoReferenceCount {};
+
+/// Disabled reference counting: empty, so that it takes no space as a base class.
+template <>
+class BasicReferenceCounter<false> {
+public:
+    explicit BasicReferenceCounter(NoReferenceCount&) {}
 };
 
+template <bool Enabled>
+using ReferenceCount = std::conditional_t<Enabled, int, NoReferenceCount>;
+
+[[nodiscard]] constexpr int get_reference_count(int count) { return count; }
+[[nodiscard]] constexpr int get_reference_count(NoReferenceCount) { return 0; }
+
+using ReferenceCounter = BasicReferenceCounter<true>;
+
+/// Mixes `value` into `seed`, as done by boost::hash_combine.
+constexpr void hash_combine(std::size_t& seed, std::size_t value) {
+    seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+}
+
 } // namespace utils
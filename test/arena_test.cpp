@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+
+#include <cstring>
+
+#include "arena.hpp"
+
+using utils::Arena;
+
+TEST(Arena, AllocatesContiguously) {
+    Arena arena;
+    auto a = static_cast<std::byte*>(arena.allocate(24));
+    auto b = static_cast<std::byte*>(arena.allocate(24));
+    EXPECT_EQ(b - a, Arena::get_block_size(24));
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(a) % Arena::granularity, 0);
+}
+
+TEST(Arena, ReusesFreedBlocksOfSameSizeClass) {
+    Arena arena;
+    auto a = arena.allocate(40);
+    auto b = arena.allocate(8);
+    arena.deallocate(a, 40);
+
+    // Different size class gets fresh memory.
+    EXPECT_NE(arena.allocate(8), a);
+
+    // Same size class reuses the freed block.
+    EXPECT_EQ(arena.allocate(33), a);
+    EXPECT_NE(arena.allocate(40), a);
+    EXPECT_NE(b, a);
+}
+
+TEST(Arena, GrowsBeyondInitialChunk) {
+    Arena arena(64);
+    auto small = arena.allocate(16);
+    auto large = arena.allocate(1000);
+    EXPECT_NE(small, large);
+    // Writing to the whole block must be valid.
+    std::memset(large, 0, 1000);
+}
+
+TEST(Arena, ReservesContiguousMemory) {
+    Arena arena(64);
+    auto initial = static_cast<std::byte*>(arena.allocate(16));
+    EXPECT_EQ(Arena::get_block_size(24), 32);
+    EXPECT_EQ(Arena::get_block_size(1), Arena::granularity);
+
+    // The reserved blocks do not fit into the initial chunk, so they come from a new one.
+    arena.reserve(100 * Arena::get_block_size(24));
+    auto first = static_cast<std::byte*>(arena.allocate(24));
+    EXPECT_NE(first, initial + Arena::granularity);
+    std::byte* last = first;
+    for (auto i = 1; i < 100; ++i) last = static_cast<std::byte*>(arena.allocate(24));
+    EXPECT_EQ(last - first, 99 * 32);
+}
+
+TEST(Arena, CreatesObjects) {
+    Arena arena;
+    auto str = arena.create<std::string>("a string that does not fit into the small string buffer");
+    EXPECT_EQ(*str, "a string that does not fit into the small string buffer");
+    std::destroy_at(str);
+}
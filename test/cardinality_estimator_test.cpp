@@ -0,0 +1,131 @@
+#include "gtest/gtest.h"
+
+#include "cardinality_estimator.hpp"
+
+namespace {
+
+StatisticsCatalog make_catalog() {
+    StatisticsCatalog catalog;
+    catalog.add_table("tbl_a", { 10'000, { { "x", { 100, 0, 1000 } }, { "name", { 5'000 } } } });
+    catalog.add_table("tbl_b", { 1'000, { { "x", { 1'000, 0, 1000 } } } });
+    return catalog;
+}
+
+} // namespace
+
+TEST(CardinalityEstimator, EstimatesSelectivitiesFromStatistics) {
+    CardinalityEstimator estimator(make_catalog());
+    LQP lqp;
+    const auto& tbl_a = lqp.make_node<StoredTableNode>("tbl_a");
+    auto selectivity = [&](std::string predicate) {
+        return estimator.estimate_selectivity(lqp.make_node<PredicateNode>(std::move(predicate), tbl_a).get_predicate());
+    };
+
+    EXPECT_DOUBLE_EQ(selectivity("tbl_a.x = 5"), 0.01);
+    EXPECT_DOUBLE_EQ(selectivity("tbl_a.name = 'a = b'"), 0.0002);
+    EXPECT_DOUBLE_EQ(selectivity("tbl_a.x != 5"), 0.99);
+    EXPECT_DOUBLE_EQ(selectivity("tbl_a.x < 250"), 0.25);
+    EXPECT_DOUBLE_EQ(selectivity("tbl_a.x >= 250"), 0.75);
+    EXPECT_DOUBLE_EQ(selectivity("250 > tbl_a.x"), 0.25);
+    EXPECT_DOUBLE_EQ(selectivity("tbl_a.x > 2000"), 0);
+
+    // Join keys: one of the larger number of distinct values.
+    EXPECT_DOUBLE_EQ(selectivity("tbl_a.x = tbl_b.x"), 0.001);
+
+    // Conjunctions and disjunctions assume independence.
+    EXPECT_DOUBLE_EQ(selectivity("tbl_a.x < 500 AND tbl_a.x = 5"), 0.005);
+    EXPECT_DOUBLE_EQ(selectivity("tbl_a.x < 500 OR tbl_a.x > 750"), 1 - 0.5 * 0.75);
+
+    // Without statistics, the heuristic guesses are used.
+    EXPECT_DOUBLE_EQ(selectivity("tbl_c.y = 1"), HeuristicCardinalityEstimator::equality_selectivity);
+    EXPECT_DOUBLE_EQ(selectivity("tbl_a.name < 'c'"), HeuristicCardinalityEstimator::range_selectivity);
+    EXPECT_DOUBLE_EQ(selectivity("is_valid(tbl_a.x)"), HeuristicCardinalityEstimator::default_selectivity);
+}
+
+TEST(CardinalityEstimator, EstimatesCardinalities) {
+    // [Predicate tbl_a.x = tbl_b.x]
+    //  \_[Join]
+    //     \_[Predicate tbl_a.x < 500]
+    //     |  \_[StoredTable a]
+    //     \_[StoredTable b]
+    CardinalityEstimator estimator(make_catalog());
+    LQP lqp;
+    const auto& predicate_a = lqp.make_node<PredicateNode>("tbl_a.x < 500", lqp.make_node<StoredTableNode>("tbl_a"));
+    const auto& join = lqp.make_node<JoinNode>(predicate_a, lqp.make_node<StoredTableNode>("tbl_b"));
+    lqp.set_root(lqp.make_node<PredicateNode>("tbl_a.x = tbl_b.x", join));
+
+    EXPECT_DOUBLE_EQ(estimator.estimate_cardinality(lqp, predicate_a), 5'000);
+    EXPECT_DOUBLE_EQ(estimator.estimate_cardinality(lqp, join), 5'000'000);
+    EXPECT_DOUBLE_EQ(estimator.estimate_cardinality(lqp, lqp.get_root()), 5'000);
+    EXPECT_DOUBLE_EQ(estimator.estimate_cardinality(lqp, lqp.make_node<StoredTableNode>("tbl_c")),
+                     HeuristicCardinalityEstimator::table_cardinality);
+}
+
+TEST(CardinalityEstimator, EstimatesJoinModes) {
+    // Each of the 1'000 rows of tbl_b matches 10 of the 10'000 rows of tbl_a on x.
+    CardinalityEstimator estimator(make_catalog());
+    LQP lqp;
+    const auto& tbl_a = lqp.make_node<StoredTableNode>("tbl_a");
+    const auto& tbl_b = lqp.make_node<StoredTableNode>("tbl_b");
+    auto cardinality = [&](JoinMode mode, const AbstractLQPNode& left, const AbstractLQPNode& right) {
+        return estimator.estimate_cardinality(lqp, lqp.make_node<JoinNode>(mode, "tbl_a.x = tbl_b.x", left, right));
+    };
+
+    EXPECT_DOUBLE_EQ(cardinality(JoinMode::Inner, tbl_b, tbl_a), 10'000);
+    EXPECT_DOUBLE_EQ(cardinality(JoinMode::Left, tbl_b, tbl_a), 10'000);
+    EXPECT_DOUBLE_EQ(cardinality(JoinMode::Semi, tbl_b, tbl_a), 1'000);
+    EXPECT_DOUBLE_EQ(cardinality(JoinMode::Anti, tbl_b, tbl_a), 0);
+
+    // Restricted to tbl_b.x < 500, half of the tbl_a rows have a match.
+    const auto& filtered_b = lqp.make_node<PredicateNode>("tbl_b.x < 500", tbl_b);
+    EXPECT_DOUBLE_EQ(cardinality(JoinMode::Inner, tbl_a, filtered_b), 5'000);
+    EXPECT_DOUBLE_EQ(cardinality(JoinMode::Left, tbl_a, filtered_b), 10'000);
+    EXPECT_DOUBLE_EQ(cardinality(JoinMode::Semi, tbl_a, filtered_b), 5'000);
+    EXPECT_DOUBLE_EQ(cardinality(JoinMode::Anti, tbl_a, filtered_b), 5'000);
+}
+
+TEST(CardinalityEstimator, ReestimatesChangedSubplansOnly) {
+    CardinalityEstimator estimator(make_catalog());
+    LQP lqp;
+    const auto& tbl_a = lqp.make_node<StoredTableNode>("tbl_a");
+    const auto& tbl_b = lqp.make_node<StoredTableNode>("tbl_b");
+    const auto& join = lqp.make_node<JoinNode>(lqp.make_node<PredicateNode>("tbl_a.x < 500", tbl_a), tbl_b);
+    lqp.set_root(lqp.make_node<PredicateNode>("tbl_a.x = tbl_b.x", join));
+
+    EXPECT_DOUBLE_EQ(estimator.estimate_cardinality(lqp, lqp.get_root()), 5'000);
+    EXPECT_EQ(estimator.get_estimated_node_count(), 5);
+    EXPECT_DOUBLE_EQ(estimator.estimate_cardinality(lqp, lqp.get_root()), 5'000);
+    EXPECT_EQ(estimator.get_estimated_node_count(), 5);
+
+    // Filtering tbl_b invalidates the new predicate, the join and the root, but not the tbl_a side.
+    const auto& predicate_b = lqp.wrap_node_with<PredicateNode>(tbl_b, "tbl_b.x < 100");
+    EXPECT_DOUBLE_EQ(estimator.estimate_cardinality(lqp, lqp.get_root()), 500);
+    EXPECT_EQ(estimator.get_estimated_node_count(), 5 + 3);
+
+    lqp.bypass_node(predicate_b);
+    EXPECT_DOUBLE_EQ(estimator.estimate_cardinality(lqp, lqp.get_root()), 5'000);
+    EXPECT_EQ(estimator.get_estimated_node_count(), 5 + 3 + 2);
+
+    // The id of the bypassed predicate is reused by a new node, which must not see its estimate.
+    const auto& tbl_c = lqp.make_node<StoredTableNode>("tbl_c");
+    EXPECT_DOUBLE_EQ(estimator.estimate_cardinality(lqp, tbl_c), HeuristicCardinalityEstimator::table_cardinality);
+
+    // Another LQP does not see the estimates of the first one.
+    LQP other_lqp;
+    other_lqp.set_root(other_lqp.make_node<StoredTableNode>("tbl_b"));
+    EXPECT_DOUBLE_EQ(estimator.estimate_cardinality(other_lqp, other_lqp.get_root()), 1'000);
+}
+
+TEST(CardinalityEstimator, EstimatesDeepPlansHeuristicallyOnce) {
+    LQP lqp;
+    const AbstractLQPNode* plan = &lqp.make_node<StoredTableNode>("tbl_a");
+    for (auto i = 0; i < 100'000; ++i) plan = &lqp.make_node<ProjectionNode>("tbl_a.x", *plan);
+    const auto& root = lqp.make_node<PredicateNode>("tbl_a.x = 1", *plan);
+
+    HeuristicCardinalityEstimator estimator;
+    EXPECT_DOUBLE_EQ(estimator.estimate_cardinality(lqp, root), HeuristicCardinalityEstimator::table_cardinality
+                                                                * HeuristicCardinalityEstimator::equality_selectivity);
+    EXPECT_EQ(estimator.get_estimated_node_count(), lqp.get_node_count());
+    EXPECT_DOUBLE_EQ(estimator.estimate_cardinality(lqp, *plan), HeuristicCardinalityEstimator::table_cardinality);
+    EXPECT_EQ(estimator.get_estimated_node_count(), lqp.get_node_count());
+}
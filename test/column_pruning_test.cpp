@@ -0,0 +1,139 @@
+#include "gtest/gtest.h"
+
+#include "column_pruning.hpp"
+#include "lqp_copy.hpp"
+
+TEST(ColumnPruning, ParsesAndCopiesProjections) {
+    LQP lqp;
+    const auto& projection = lqp.make_node<ProjectionNode>("tbl_a.x, tbl_a.y + 1", lqp.make_node<StoredTableNode>("tbl_a"));
+    EXPECT_EQ(projection.get_expressions().size(), 2);
+    EXPECT_EQ(projection.get_expressions_string(), "tbl_a.x, tbl_a.y + 1");
+    EXPECT_TRUE(lqp.make_node<ProjectionNode>("", projection).get_expressions().empty());
+
+    LQP copy;
+    const auto& projection_copy = copy_subplan(copy, lqp, projection);
+    EXPECT_TRUE(structurally_equal(projection_copy, projection));
+    EXPECT_FALSE(structurally_equal(
+            copy.make_node<ProjectionNode>("tbl_a.y + 1, tbl_a.x", copy.make_node<StoredTableNode>("tbl_a")), projection));
+}
+
+TEST(ColumnPruning, ProjectsRequiredColumnsOfTables) {
+    // [Projection tbl_a.x, tbl_b.z]
+    //  \_[Predicate tbl_a.y > 1]
+    //     \_[Join]
+    //        \_[Predicate tbl_a.x = tbl_c.x]
+    //        |  \_[Join]
+    //        |     \_[StoredTable a]
+    //        |     \_[StoredTable c]
+    //        \_[StoredTable b]
+    LQP lqp;
+    const auto& join = lqp.make_node<JoinNode>(
+            lqp.make_node<PredicateNode>("tbl_a.x = tbl_c.x", lqp.make_node<JoinNode>(
+                    lqp.make_node<StoredTableNode>("tbl_a"), lqp.make_node<StoredTableNode>("tbl_c"))),
+            lqp.make_node<StoredTableNode>("tbl_b"));
+    lqp.set_root(lqp.make_node<ProjectionNode>("tbl_a.x, tbl_b.z", lqp.make_node<PredicateNode>("tbl_a.y > 1", join)));
+
+    ColumnPruningRule rule;
+    rule.apply(lqp, 0);
+
+    LQP expected_lqp;
+    const auto& expected_join = expected_lqp.make_node<JoinNode>(
+            expected_lqp.make_node<PredicateNode>("tbl_a.x = tbl_c.x", expected_lqp.make_node<JoinNode>(
+                    expected_lqp.make_node<ProjectionNode>("tbl_a.x, tbl_a.y", expected_lqp.make_node<StoredTableNode>("tbl_a")),
+                    expected_lqp.make_node<ProjectionNode>("tbl_c.x", expected_lqp.make_node<StoredTableNode>("tbl_c")))),
+            expected_lqp.make_node<ProjectionNode>("tbl_b.z", expected_lqp.make_node<StoredTableNode>("tbl_b")));
+    expected_lqp.set_root(expected_lqp.make_node<ProjectionNode>("tbl_a.x, tbl_b.z",
+            expected_lqp.make_node<PredicateNode>("tbl_a.y > 1", expected_join)));
+    EXPECT_TRUE(structurally_equal(lqp.get_root(), expected_lqp.get_root()));
+
+    // Applying the rule again does not change the plan.
+    auto generation = lqp.get_generation();
+    rule.apply(lqp, 0);
+    EXPECT_EQ(lqp.get_generation(), generation);
+}
+
+TEST(ColumnPruning, NarrowsProjections) {
+    // The inner projection outputs tbl_a.z, which neither the outer projection nor the predicate use. Computed
+    // expressions are kept.
+    LQP lqp;
+    const auto& inner = lqp.make_node<ProjectionNode>("tbl_a.x, tbl_a.y, tbl_a.z, tbl_a.z + 1",
+                                                      lqp.make_node<StoredTableNode>("tbl_a"));
+    lqp.set_root(lqp.make_node<ProjectionNode>("tbl_a.x", lqp.make_node<PredicateNode>("tbl_a.y < 2", inner)));
+    ColumnPruningRule().apply(lqp, 0);
+
+    const auto& narrowed = lqp.get_root().get_input_nodes()[0].get_input_nodes()[0];
+    ASSERT_EQ(narrowed.type, LQPNodeType::Projection);
+    EXPECT_EQ(static_cast<const ProjectionNode&>(narrowed).get_expressions_string(), "tbl_a.x, tbl_a.y, tbl_a.z + 1");
+    // The table is read by a projection only, so no projection is added.
+    EXPECT_EQ(narrowed.get_input_nodes()[0].type, LQPNodeType::StoredTable);
+    EXPECT_EQ(lqp.get_node_count(), 4);
+}
+
+TEST(ColumnPruning, KeepsColumnsRequiredBySharedSubplans) {
+    LQP lqp;
+    const auto& shared = lqp.make_node<StoredTableNode>("tbl_a");
+    lqp.set_root(lqp.make_node<JoinNode>(lqp.make_node<ProjectionNode>("tbl_a.x", lqp.make_node<PredicateNode>("tbl_a.y > 1", shared)),
+                                         lqp.make_node<ProjectionNode>("tbl_a.z", shared)));
+    ColumnPruningRule().apply(lqp, 0);
+
+    ASSERT_EQ(lqp.get_parent_count(shared), 1);
+    const auto& projection = *(*lqp.get_parents(shared).begin()).second;
+    ASSERT_EQ(projection.type, LQPNodeType::Projection);
+    EXPECT_EQ(static_cast<const ProjectionNode&>(projection).get_expressions_string(), "tbl_a.x, tbl_a.y, tbl_a.z");
+}
+
+TEST(ColumnPruning, KeepsTablesWithUnknownColumns) {
+    // Without a projection, the plan outputs all columns.
+    LQP lqp;
+    lqp.set_root(lqp.make_node<PredicateNode>("tbl_a.x > 1", lqp.make_node<StoredTableNode>("tbl_a")));
+    auto generation = lqp.get_generation();
+    ColumnPruningRule().apply(lqp, 0);
+    EXPECT_EQ(lqp.get_generation(), generation);
+
+    // Unqualified columns cannot be attributed to a table.
+    LQP unqualified;
+    unqualified.set_root(unqualified.make_node<ProjectionNode>("tbl_a.x", unqualified.make_node<PredicateNode>(
+            "y > 1", unqualified.make_node<JoinNode>(unqualified.make_node<StoredTableNode>("tbl_a"),
+                                                     unqualified.make_node<StoredTableNode>("tbl_b")))));
+    generation = unqualified.get_generation();
+    ColumnPruningRule().apply(unqualified, 0);
+    EXPECT_EQ(unqualified.get_generation(), generation);
+}
+
+TEST(ColumnPruning, SkipsTablesWithoutRequiredColumns) {
+    // No column of tbl_b is required, but its rows are.
+    LQP lqp;
+    const auto& tbl_b = lqp.make_node<StoredTableNode>("tbl_b");
+    lqp.set_root(lqp.make_node<ProjectionNode>("tbl_a.x", lqp.make_node<JoinNode>(
+            lqp.make_node<PredicateNode>("tbl_a.y > 1", lqp.make_node<StoredTableNode>("tbl_a")), tbl_b)));
+    ColumnPruningRule().apply(lqp, 0);
+
+    ASSERT_EQ(lqp.get_parent_count(tbl_b), 1);
+    EXPECT_EQ((*lqp.get_parents(tbl_b).begin()).second->type, LQPNodeType::Join);
+    EXPECT_EQ(lqp.get_node_count(), 6);
+}
+
+TEST(ColumnPruning, KeepsProjectionsWithoutRequiredColumns) {
+    // No column of the right projection is required, but its rows are.
+    LQP lqp;
+    const auto& projection = lqp.make_node<ProjectionNode>("tbl_b.y", lqp.make_node<StoredTableNode>("tbl_b"));
+    lqp.set_root(lqp.make_node<ProjectionNode>("tbl_a.x", lqp.make_node<JoinNode>(
+            lqp.make_node<StoredTableNode>("tbl_a"), projection)));
+    ColumnPruningRule().apply(lqp, 0);
+
+    const auto& right = lqp.get_root().get_input_nodes()[0].get_input_nodes()[1];
+    EXPECT_EQ(&right, &projection);
+    EXPECT_EQ(projection.get_expressions_string(), "tbl_b.y");
+}
+
+TEST(ColumnPruning, IgnoresParentsNotReachableFromTheRoot) {
+    // The table is read by a projection only, as the predicate is left over from a rewrite.
+    LQP lqp;
+    const auto& table = lqp.make_node<StoredTableNode>("tbl_a");
+    static_cast<void>(lqp.make_node<PredicateNode>("tbl_a.y > 1", table));
+    lqp.set_root(lqp.make_node<ProjectionNode>("tbl_a.x", table));
+    auto generation = lqp.get_generation();
+    ColumnPruningRule().apply(lqp, 0);
+    EXPECT_EQ(lqp.get_generation(), generation);
+    EXPECT_EQ(lqp.get_node_count(), 3);
+}
@@ -0,0 +1,70 @@
+#include "gtest/gtest.h"
+
+#include "common_subplan_elimination.hpp"
+#include "lqp_nodes.hpp"
+
+TEST(CommonSubplanElimination, MergesIdenticalSubplans) {
+    // [Join]
+    //  \_[Join]
+    //  |  \_[Predicate a]
+    //  |  |  \_[StoredTable a]
+    //  |  \_[StoredTable b]
+    //  \_[Predicate a]
+    //     \_[StoredTable a]
+    LQP lqp;
+    const auto& predicate = lqp.make_node<PredicateNode>("a", lqp.make_node<StoredTableNode>("tbl_a"));
+    const auto& inner_join = lqp.make_node<JoinNode>(predicate, lqp.make_node<StoredTableNode>("tbl_b"));
+    const auto& root = lqp.make_node<JoinNode>(
+            inner_join, lqp.make_node<PredicateNode>("a", lqp.make_node<StoredTableNode>("tbl_a")));
+    lqp.set_root(root);
+    auto original_hash = root.get_structural_hash();
+
+    EXPECT_EQ(eliminate_common_subplans(lqp), 2);
+    EXPECT_EQ(lqp.get_node_count(), 5);
+    EXPECT_EQ(lqp.get_parent_count(predicate), 2);
+    EXPECT_EQ(&root.get_input_nodes()[1], &predicate);
+
+    // The plan is still the same.
+    EXPECT_EQ(root.get_structural_hash(), original_hash);
+
+    // Nothing left to merge.
+    EXPECT_EQ(eliminate_common_subplans(lqp), 0);
+}
+
+TEST(CommonSubplanElimination, KeepsDuplicateInputsOfTheSameNode) {
+    LQP lqp;
+    lqp.set_root(lqp.make_node<JoinNode>(lqp.make_node<StoredTableNode>("tbl_a"),
+                                         lqp.make_node<StoredTableNode>("tbl_a")));
+    EXPECT_EQ(eliminate_common_subplans(lqp), 0);
+    EXPECT_EQ(lqp.get_node_count(), 3);
+}
+
+TEST(CommonSubplanElimination, RemovesDuplicateInputsOfMergedNodes) {
+    // [Join]
+    //  \_[Predicate x]
+    //  |  \_[Join]
+    //  |     \_[StoredTable a]
+    //  |     \_[StoredTable a]
+    //  \_[Predicate y]
+    //     \_[Join]
+    //        \_[StoredTable a]
+    //        \_[StoredTable a]
+    LQP lqp;
+    auto make_join = [&]() -> const AbstractLQPNode& {
+        return lqp.make_node<JoinNode>(lqp.make_node<StoredTableNode>("tbl_a"), lqp.make_node<StoredTableNode>("tbl_a"));
+    };
+    const auto& left = lqp.make_node<PredicateNode>("tbl_a.x > 1", make_join());
+    const auto& right = lqp.make_node<PredicateNode>("tbl_a.y > 1", make_join());
+    lqp.set_root(lqp.make_node<JoinNode>(left, right));
+    ASSERT_EQ(lqp.get_node_count(), 9);
+
+    // The second table of the removed join is kept side by side with the first one and removed along with the join.
+    EXPECT_EQ(eliminate_common_subplans(lqp), 3);
+    EXPECT_EQ(lqp.get_node_count(), 6);
+    std::size_t reachable_count = 0;
+    lqp.visit<LQP::VisitOrder::PreOrder, LQP::SharedNodes::VisitOnce>(lqp.get_root(),
+                                                                     [&](const AbstractLQPNode&) { ++reachable_count; });
+    EXPECT_EQ(reachable_count, 6);
+    EXPECT_EQ(&left.get_input_nodes()[0], &right.get_input_nodes()[0]);
+    EXPECT_EQ(eliminate_common_subplans(lqp), 0);
+}
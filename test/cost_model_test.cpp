@@ -0,0 +1,63 @@
+#include "gtest/gtest.h"
+
+#include "cost_model.hpp"
+
+namespace {
+
+CostModel make_cost_model() {
+    StatisticsCatalog catalog;
+    catalog.add_table("tbl_a", { 10'000, { { "x", { 100, 0, 1000 } } } });
+    catalog.add_table("tbl_b", { 1'000, { { "x", { 1'000, 0, 1000 } } } });
+    return CostModel(std::make_unique<CardinalityEstimator>(std::move(catalog)));
+}
+
+} // namespace
+
+TEST(CostModel, AddsUpOperatorCosts) {
+    auto cost_model = make_cost_model();
+    LQP lqp;
+    const auto& predicate = lqp.make_node<PredicateNode>("tbl_a.x < 500", lqp.make_node<StoredTableNode>("tbl_a"));
+    const auto& tbl_b = lqp.make_node<StoredTableNode>("tbl_b");
+    lqp.set_root(lqp.make_node<JoinNode>(predicate, tbl_b));
+
+    EXPECT_DOUBLE_EQ(cost_model.estimate_operator_cost(lqp, tbl_b), 1'000);
+    EXPECT_DOUBLE_EQ(cost_model.estimate_operator_cost(lqp, predicate), 0.1 * 10'000);
+    EXPECT_DOUBLE_EQ(cost_model.estimate_cost(lqp, predicate), 10'000 + 0.1 * 10'000);
+
+    // Probe with the 5'000 filtered rows of tbl_a, build on the 1'000 rows of tbl_b, output the cross product.
+    auto join_cost = 0.2 * 5'000 + 0.5 * 1'000 + 0.1 * 5'000'000;
+    EXPECT_DOUBLE_EQ(cost_model.estimate_operator_cost(lqp, lqp.get_root()), join_cost);
+    EXPECT_DOUBLE_EQ(cost_model.estimate_cost(lqp, lqp.get_root()), 11'000 + 1'000 + join_cost);
+}
+
+TEST(CostModel, PrefersSmallerBuildSide) {
+    auto cost_model = make_cost_model();
+    LQP lqp;
+    const auto& tbl_a = lqp.make_node<StoredTableNode>("tbl_a");
+    const auto& tbl_b = lqp.make_node<StoredTableNode>("tbl_b");
+    const auto& build_on_b = lqp.make_node<JoinNode>(tbl_a, tbl_b);
+    const auto& build_on_a = lqp.make_node<JoinNode>(tbl_b, tbl_a);
+
+    EXPECT_LT(cost_model.estimate_cost(lqp, build_on_b), cost_model.estimate_cost(lqp, build_on_a));
+}
+
+TEST(CostModel, RecostsChangedSubplansOnly) {
+    auto cost_model = make_cost_model();
+    LQP lqp;
+    const auto& tbl_b = lqp.make_node<StoredTableNode>("tbl_b");
+    const auto& join = lqp.make_node<JoinNode>(
+            lqp.make_node<PredicateNode>("tbl_a.x < 500", lqp.make_node<StoredTableNode>("tbl_a")), tbl_b);
+    lqp.set_root(lqp.make_node<PredicateNode>("tbl_a.x = tbl_b.x", join));
+
+    auto cost = cost_model.estimate_cost(lqp, lqp.get_root());
+    EXPECT_EQ(cost_model.get_costed_node_count(), 5);
+
+    // Filtering tbl_b recosts the new predicate, the join and the root, and makes the plan cheaper.
+    const auto& predicate_b = lqp.wrap_node_with<PredicateNode>(tbl_b, "tbl_b.x < 100");
+    EXPECT_LT(cost_model.estimate_cost(lqp, lqp.get_root()), cost);
+    EXPECT_EQ(cost_model.get_costed_node_count(), 5 + 3);
+
+    lqp.bypass_node(predicate_b);
+    EXPECT_DOUBLE_EQ(cost_model.estimate_cost(lqp, lqp.get_root()), cost);
+    EXPECT_EQ(cost_model.get_costed_node_count(), 5 + 3 + 2);
+}
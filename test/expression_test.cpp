@@ -0,0 +1,89 @@
+#include "gtest/gtest.h"
+
+#include "expression_parser.hpp"
+#include "lqp.hpp"
+#include "lqp_nodes.hpp"
+
+TEST(Expression, ParsesPredicates) {
+    ExpressionPool pool;
+    const auto& predicate = parse_expression(pool, "tbl_a.x = tbl_b.x AND (z < 1 or f(tbl_a.y, 'a b'))");
+    ASSERT_EQ(predicate.type, ExpressionType::And);
+    const auto& comparison = static_cast<const BinaryExpression&>(*predicate.get_arguments()[0]);
+    EXPECT_EQ(comparison.type, ExpressionType::Equals);
+    ASSERT_EQ(comparison.get_left().type, ExpressionType::Column);
+    EXPECT_EQ(static_cast<const ColumnExpression&>(comparison.get_left()).get_table(), "tbl_a");
+    EXPECT_EQ(static_cast<const ColumnExpression&>(comparison.get_left()).get_column(), "x");
+
+    const auto& disjunction = *predicate.get_arguments()[1];
+    ASSERT_EQ(disjunction.type, ExpressionType::Or);
+    const auto& function = *disjunction.get_arguments()[1];
+    ASSERT_EQ(function.type, ExpressionType::Function);
+    ASSERT_EQ(function.get_arguments().size(), 2);
+    EXPECT_EQ(static_cast<const ConstantExpression&>(*function.get_arguments()[1]).get_value(),
+              ConstantExpression::Value("a b"));
+
+    EXPECT_EQ(get_referenced_table_names(predicate), (std::vector<std::string>{ "tbl_a", "tbl_b" }));
+    EXPECT_THROW((void)parse_expression(pool, "tbl_a.x <"), std::logic_error);
+    EXPECT_THROW((void)parse_expression(pool, "(a"), std::logic_error);
+    EXPECT_THROW((void)parse_expression(pool, "a b"), std::logic_error);
+}
+
+TEST(Expression, PrintsParseableText) {
+    ExpressionPool pool;
+    for (const auto* text : { "tbl_a.x = 1", "a <= -2.5 OR b != 'x y' AND c > $3", "(a OR b) AND c",
+                              "a + (b + c) >= 1", "is_valid(tbl_a.x, 2)", "(a = b) = c" }) {
+        const auto& expression = parse_expression(pool, text);
+        EXPECT_EQ(to_string(expression), text);
+        EXPECT_EQ(&parse_expression(pool, to_string(expression)), &expression);
+    }
+    EXPECT_EQ(to_string(parse_expression(pool, "a<>1 and B == 2")), "a != 1 AND B = 2");
+}
+
+TEST(Expression, ComparesStructurally) {
+    ExpressionPool pool;
+    ExpressionPool other_pool;
+    const auto& expression = parse_expression(pool, "tbl_a.x < 10 AND tbl_b.y = 'a'");
+    EXPECT_TRUE(expressions_equal(expression, parse_expression(other_pool, "tbl_a.x < 10 AND tbl_b.y = 'a'")));
+    EXPECT_EQ(expression.get_hash(), parse_expression(other_pool, "tbl_a.x < 10 AND tbl_b.y = 'a'").get_hash());
+    EXPECT_FALSE(expressions_equal(expression, parse_expression(other_pool, "tbl_a.x < 10 AND tbl_b.y = 'b'")));
+    EXPECT_FALSE(expressions_equal(expression, parse_expression(other_pool, "tbl_a.x <= 10 AND tbl_b.y = 'a'")));
+    EXPECT_FALSE(expressions_equal(parse_expression(pool, "1"), parse_expression(other_pool, "'1'")));
+}
+
+TEST(Expression, InternsEqualExpressions) {
+    ExpressionPool pool;
+    const auto& expression = parse_expression(pool, "tbl_a.x < 10 AND tbl_a.x = 'a'");
+    EXPECT_EQ(pool.size(), 6);
+    EXPECT_EQ(&parse_expression(pool, "tbl_a.x < 10 AND tbl_a.x = 'a'"), &expression);
+    EXPECT_EQ(&pool.make<ColumnExpression>("tbl_a", "x"), expression.get_arguments()[0]->get_arguments()[0]);
+    EXPECT_NE(&parse_expression(pool, "tbl_a.x <= 10 AND tbl_a.x = 'a'"), &expression);
+    EXPECT_NE(&parse_expression(pool, "1"), &parse_expression(pool, "'1'"));
+
+    // Expressions of different pools are equal, but not the same object, until imported.
+    ExpressionPool other_pool;
+    const auto& copy = parse_expression(other_pool, "tbl_a.x < 10 AND tbl_a.x = 'a'");
+    EXPECT_TRUE(expressions_equal(copy, expression));
+    EXPECT_EQ(copy.get_hash(), expression.get_hash());
+    EXPECT_FALSE(pool.contains(copy));
+    EXPECT_EQ(&pool.import(copy), &expression);
+    EXPECT_EQ(&other_pool.import(copy), &copy);
+
+    const auto& foreign_column = other_pool.make<ColumnExpression>("tbl_a", "y");
+    EXPECT_THROW((void)pool.make<BinaryExpression>(ExpressionType::Equals, foreign_column, foreign_column),
+                 std::logic_error);
+}
+
+TEST(Expression, SharesPredicatesWithinLQP) {
+    LQP lqp;
+    const auto& table = lqp.make_node<StoredTableNode>("tbl_a");
+    const auto& first = lqp.make_node<PredicateNode>("tbl_a.x < 10", table);
+    const auto& second = lqp.make_node<PredicateNode>("tbl_a.x < 10", first);
+    EXPECT_EQ(&first.get_predicate(), &second.get_predicate());
+    EXPECT_TRUE(lqp.get_expression_pool().contains(first.get_predicate()));
+
+    // Predicates of other LQPs are imported.
+    LQP other;
+    const auto& copy = other.make_node<PredicateNode>(first.get_predicate(), other.make_node<StoredTableNode>("tbl_a"));
+    EXPECT_TRUE(other.get_expression_pool().contains(copy.get_predicate()));
+    EXPECT_TRUE(copy.shallow_equals(first));
+}
@@ -0,0 +1,72 @@
+#include "gtest/gtest.h"
+
+#include "flat_reverse_index.hpp"
+
+namespace {
+
+struct Node {
+    std::uint32_t id;
+    [[nodiscard]] std::uint32_t get_id() const { return id; }
+};
+
+static_assert(ReverseIndex<FlatReverseDAGIndex<Node>, Node>);
+static_assert(ReverseIndex<ReverseDAGIndex<Node>, Node>);
+
+} // namespace
+
+TEST(FlatReverseDAGIndex, AddsAndRemoves) {
+    Node a{0}, b{1};
+    FlatReverseDAGIndex<Node> parents;
+
+    EXPECT_EQ(parents.get_parent_count(a), 0);
+    parents.add(a, b);
+    EXPECT_EQ(parents.get_parent_count(a), 1);
+    EXPECT_EQ(parents.get_parent_count(b), 0);
+
+    // Add same link again.
+    EXPECT_THROW(parents.add(a, b), std::logic_error);
+
+    parents.remove(a, b);
+    EXPECT_EQ(parents.get_parent_count(a), 0);
+    EXPECT_EQ(parents.get_parent_count(b), 0);
+
+    // Remove non-existent link.
+    EXPECT_THROW(parents.remove(a, b), std::logic_error);
+    EXPECT_THROW(parents.remove(Node{7}, b), std::logic_error);
+}
+
+TEST(FlatReverseDAGIndex, ReplacesInput) {
+    Node a{0}, b{1}, c{2};
+    FlatReverseDAGIndex<Node> parents;
+
+    parents.add(a, c);
+
+    // B doesn't exist, but that's OK, it simply has no parents.
+    EXPECT_NO_THROW(parents.replace_input(b, c));
+
+    // Replace an input with one that already has parents.
+    EXPECT_THROW(parents.replace_input(b, a), std::logic_error);
+
+    parents.replace_input(a, b);
+    EXPECT_EQ(parents.get_parent_count(a), 0);
+    EXPECT_EQ(parents.get_parent_count(b), 1);
+}
+
+TEST(FlatReverseDAGIndex, SpillsAndShrinksParentLists) {
+    Node input{0};
+    std::vector<Node> nodes{{1}, {2}, {3}, {4}};
+    FlatReverseDAGIndex<Node> parents;
+
+    for (const auto& node : nodes) parents.add(input, node);
+    EXPECT_EQ(parents.get_parent_count(input), 4);
+
+    parents.remove(input, nodes[1]);
+    parents.remove(input, nodes[3]);
+
+    std::vector<const Node*> remaining;
+    for (const auto& [link_input, parent] : parents.get_parents(input)) {
+        EXPECT_EQ(link_input, &input);
+        remaining.push_back(parent);
+    }
+    EXPECT_EQ(remaining, (std::vector<const Node*>{&nodes[0], &nodes[2]}));
+}
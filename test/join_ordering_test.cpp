@@ -0,0 +1,264 @@
+#include <string>
+#include <unordered_map>
+
+#include "gtest/gtest.h"
+
+#include "join_ordering.hpp"
+
+namespace {
+
+/// Table sizes from a map and a fixed selectivity for all predicates.
+class TableSizeEstimator final : public AbstractCardinalityEstimator {
+private:
+    std::unordered_map<std::string, double> table_sizes;
+
+public:
+    explicit TableSizeEstimator(std::unordered_map<std::string, double> table_sizes)
+            : table_sizes(std::move(table_sizes)) {}
+
+    [[nodiscard]] double estimate_cardinality(const LQP&, const AbstractLQPNode& node) override {
+        return table_sizes.at(static_cast<const StoredTableNode&>(node).get_name());
+    }
+
+    [[nodiscard]] double estimate_selectivity(const AbstractExpression&) override { return 0.01; }
+};
+
+double get_block_cost(const LQP& lqp, AbstractCardinalityEstimator& estimator) {
+    auto graph = extract_join_graph(lqp, lqp.get_root(), estimator);
+    return estimate_join_tree_cost(graph, graph.current_tree);
+}
+
+} // namespace
+
+TEST(JoinOrdering, ExtractsJoinGraph) {
+    // [Predicate tbl_a, tbl_b]
+    //  \_[Join]
+    //     \_[Predicate tbl_a]
+    //     |  \_[StoredTable a]
+    //     \_[Join]
+    //        \_[StoredTable b]
+    //        \_[StoredTable c]
+    LQP lqp;
+    const auto& tbl_a = lqp.make_node<PredicateNode>("tbl_a.x > 1", lqp.make_node<StoredTableNode>("tbl_a"));
+    const auto& join = lqp.make_node<JoinNode>(tbl_a, lqp.make_node<JoinNode>(
+            lqp.make_node<StoredTableNode>("tbl_b"), lqp.make_node<StoredTableNode>("tbl_c")));
+    lqp.set_root(lqp.make_node<PredicateNode>("tbl_a.x = tbl_b.y AND z = 1", join));
+
+    EXPECT_TRUE(is_join_block_root(lqp, lqp.get_root()));
+    EXPECT_FALSE(is_join_block_root(lqp, join));
+    EXPECT_FALSE(is_join_block_node(lqp, tbl_a));
+
+    HeuristicCardinalityEstimator estimator;
+    auto graph = extract_join_graph(lqp, lqp.get_root(), estimator);
+    ASSERT_EQ(graph.relations.size(), 3);
+    EXPECT_EQ(graph.relations[0], &tbl_a);
+    EXPECT_EQ(graph.nodes.size(), 3);
+    ASSERT_EQ(graph.predicates.size(), 1);
+    EXPECT_EQ(graph.predicates[0].relations, (std::vector<std::size_t>{ 0, 1 }));
+    EXPECT_EQ(graph.predicates[0].selectivity, HeuristicCardinalityEstimator::equality_selectivity);
+
+    // Join(tbl_a, Join(tbl_b, tbl_c)), operands after the three relations refer to joins.
+    ASSERT_EQ(graph.current_tree.joins.size(), 2);
+    EXPECT_EQ(graph.current_tree.joins[0].left, 1);
+    EXPECT_EQ(graph.current_tree.joins[0].right, 2);
+    EXPECT_EQ(graph.current_tree.joins[1].left, 0);
+    EXPECT_EQ(graph.current_tree.joins[1].right, 3);
+}
+
+TEST(JoinOrdering, AvoidsCrossProducts) {
+    // [Predicate tbl_b, tbl_c]
+    //  \_[Predicate tbl_a, tbl_b]
+    //     \_[Join]
+    //        \_[Join]
+    //        |  \_[StoredTable a]
+    //        |  \_[StoredTable c]
+    //        \_[StoredTable b]
+    LQP lqp;
+    const auto& join = lqp.make_node<JoinNode>(lqp.make_node<StoredTableNode>("tbl_a"), lqp.make_node<StoredTableNode>("tbl_c"));
+    lqp.set_root(lqp.make_node<PredicateNode>("tbl_b.y = tbl_c.y", lqp.make_node<PredicateNode>("tbl_a.x = tbl_b.x",
+            lqp.make_node<JoinNode>(join, lqp.make_node<StoredTableNode>("tbl_b")))));
+
+    TableSizeEstimator estimator({ { "tbl_a", 1000 }, { "tbl_b", 10 }, { "tbl_c", 1000 } });
+    EXPECT_EQ(get_block_cost(lqp, estimator), 1'000'000 + 1000);
+
+    JoinOrderingRule rule(std::make_unique<TableSizeEstimator>(estimator));
+    rule.apply(lqp, 0);
+
+    // The join predicates become join conditions.
+    EXPECT_EQ(lqp.get_node_count(), 5);
+    EXPECT_DOUBLE_EQ(get_block_cost(lqp, estimator), 100 + 1000);
+
+    // The new order is the cheapest, so applying the rule again does not change the plan.
+    auto generation = lqp.get_generation();
+    rule.apply(lqp, 0);
+    EXPECT_EQ(lqp.get_generation(), generation);
+}
+
+TEST(JoinOrdering, JoinsSmallestDimensionsFirst) {
+    LQP lqp;
+    const auto& fact = lqp.make_node<StoredTableNode>("fact");
+    const auto& joins = lqp.make_node<JoinNode>(lqp.make_node<JoinNode>(lqp.make_node<JoinNode>(
+            lqp.make_node<StoredTableNode>("dim_c"), lqp.make_node<StoredTableNode>("dim_b")),
+            lqp.make_node<StoredTableNode>("dim_a")), fact);
+    lqp.set_root(lqp.make_node<PredicateNode>("fact.a = dim_a.a",
+            lqp.make_node<PredicateNode>("fact.b = dim_b.b", lqp.make_node<PredicateNode>("fact.c = dim_c.c", joins))));
+
+    JoinOrderingRule rule(std::make_unique<TableSizeEstimator>(std::unordered_map<std::string, double>{
+            { "fact", 1'000'000 }, { "dim_a", 10 }, { "dim_b", 100 }, { "dim_c", 1000 } }));
+    rule.apply(lqp, 0);
+
+    // Each predicate becomes the condition of the join it belongs to, the larger input goes left.
+    LQP expected_lqp;
+    const auto& expected_a = expected_lqp.make_node<JoinNode>(JoinMode::Inner, "fact.a = dim_a.a",
+            expected_lqp.make_node<StoredTableNode>("fact"), expected_lqp.make_node<StoredTableNode>("dim_a"));
+    const auto& expected_b = expected_lqp.make_node<JoinNode>(JoinMode::Inner, "fact.b = dim_b.b",
+            expected_a, expected_lqp.make_node<StoredTableNode>("dim_b"));
+    expected_lqp.set_root(expected_lqp.make_node<JoinNode>(JoinMode::Inner, "fact.c = dim_c.c",
+            expected_b, expected_lqp.make_node<StoredTableNode>("dim_c")));
+    EXPECT_TRUE(structurally_equal(lqp.get_root(), expected_lqp.get_root()));
+    EXPECT_EQ(lqp.get_parent_count(fact), 1);
+}
+
+TEST(JoinOrdering, KeepsJoinConditionsInJoins) {
+    // A query like the one above, with the join predicates as join conditions. A semi join on top ends the block.
+    LQP lqp;
+    const auto& joins = lqp.make_node<JoinNode>(JoinMode::Inner, "fact.a = dim_a.a AND fact.b = dim_b.b",
+            lqp.make_node<JoinNode>(JoinMode::Inner, "fact.c = dim_c.c AND dim_c.c > 1", lqp.make_node<JoinNode>(
+                    lqp.make_node<StoredTableNode>("dim_c"), lqp.make_node<StoredTableNode>("dim_b")),
+                    lqp.make_node<StoredTableNode>("fact")),
+            lqp.make_node<StoredTableNode>("dim_a"));
+    lqp.set_root(lqp.make_node<JoinNode>(JoinMode::Semi, "fact.d = dim_d.d", joins, lqp.make_node<StoredTableNode>("dim_d")));
+    EXPECT_FALSE(is_join_block_node(lqp, lqp.get_root()));
+
+    JoinOrderingRule rule(std::make_unique<TableSizeEstimator>(std::unordered_map<std::string, double>{
+            { "fact", 1'000'000 }, { "dim_a", 10 }, { "dim_b", 100 }, { "dim_c", 100'000 }, { "dim_d", 10 } }));
+    rule.apply(lqp, 0);
+
+    // Conjuncts referencing a single relation become predicates.
+    LQP expected_lqp;
+    const auto& expected_a = expected_lqp.make_node<JoinNode>(JoinMode::Inner, "fact.a = dim_a.a",
+            expected_lqp.make_node<StoredTableNode>("fact"), expected_lqp.make_node<StoredTableNode>("dim_a"));
+    const auto& expected_b = expected_lqp.make_node<JoinNode>(JoinMode::Inner, "fact.b = dim_b.b",
+            expected_a, expected_lqp.make_node<StoredTableNode>("dim_b"));
+    const auto& expected_c = expected_lqp.make_node<JoinNode>(JoinMode::Inner, "fact.c = dim_c.c", expected_b,
+            expected_lqp.make_node<PredicateNode>("dim_c.c > 1", expected_lqp.make_node<StoredTableNode>("dim_c")));
+    expected_lqp.set_root(expected_lqp.make_node<JoinNode>(JoinMode::Semi, "fact.d = dim_d.d", expected_c,
+                                                           expected_lqp.make_node<StoredTableNode>("dim_d")));
+    EXPECT_TRUE(structurally_equal(lqp.get_root(), expected_lqp.get_root()));
+}
+
+TEST(JoinOrdering, OrdersLongChains) {
+    // Chain tbl_0 - tbl_1 - ... - tbl_14, joined in an order in which every other join is a cross product.
+    constexpr auto table_count = 15;
+    LQP lqp;
+    std::unordered_map<std::string, double> table_sizes;
+    const AbstractLQPNode* plan = nullptr;
+    for (auto i : { 0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13 }) {
+        auto name = "tbl_" + std::to_string(i);
+        table_sizes.emplace(name, 1000 + i);
+        const auto& table = lqp.make_node<StoredTableNode>(name);
+        plan = plan ? static_cast<const AbstractLQPNode*>(&lqp.make_node<JoinNode>(*plan, table)) : &table;
+    }
+    for (auto i = 1; i < table_count; ++i) {
+        auto predicate = "tbl_" + std::to_string(i - 1) + ".x = tbl_" + std::to_string(i) + ".x";
+        plan = &lqp.make_node<PredicateNode>(predicate, *plan);
+    }
+    lqp.set_root(*plan);
+
+    TableSizeEstimator estimator(table_sizes);
+    auto graph = extract_join_graph(lqp, lqp.get_root(), estimator);
+    auto tree = DPccpJoinEnumerator(graph).enumerate();
+    ASSERT_EQ(tree.joins.size(), table_count - 1);
+    EXPECT_LT(estimate_join_tree_cost(graph, tree), estimate_join_tree_cost(graph, graph.current_tree));
+
+    auto cost = estimate_join_tree_cost(graph, tree);
+    JoinOrderingRule rule(std::make_unique<TableSizeEstimator>(estimator));
+    rule.apply(lqp, 0);
+    EXPECT_EQ(lqp.get_node_count(), 2 * table_count - 1);
+    EXPECT_DOUBLE_EQ(get_block_cost(lqp, estimator), cost);
+}
+
+TEST(JoinOrdering, TreatsSharedSubplansAsRelations) {
+    // Both blocks use the shared join of tbl_a and tbl_b as one relation.
+    LQP lqp;
+    const auto& shared = lqp.make_node<JoinNode>(lqp.make_node<StoredTableNode>("tbl_a"), lqp.make_node<StoredTableNode>("tbl_b"));
+    const auto& left = lqp.make_node<JoinNode>(shared, lqp.make_node<StoredTableNode>("tbl_c"));
+    const auto& right = lqp.make_node<JoinNode>(lqp.make_node<StoredTableNode>("tbl_d"), shared);
+    lqp.set_root(lqp.make_node<JoinNode>(left, right));
+
+    EXPECT_TRUE(is_join_block_root(lqp, shared));
+    EXPECT_FALSE(is_join_block_root(lqp, left));
+
+    // The root block reaches the shared join through both of its inputs and is left as it is.
+    HeuristicCardinalityEstimator estimator;
+    EXPECT_TRUE(extract_join_graph(lqp, lqp.get_root(), estimator).relations.empty());
+    EXPECT_EQ(extract_join_graph(lqp, shared, estimator).relations.size(), 2);
+
+    auto generation = lqp.get_generation();
+    JoinOrderingRule().apply(lqp, 0);
+    EXPECT_EQ(lqp.get_generation(), generation);
+}
+
+TEST(JoinOrdering, OrdersLargeJoinGraphsGreedily) {
+    // Chain of 100 tables joined in an order that starts with cross products.
+    constexpr auto table_count = 100;
+    LQP lqp;
+    std::unordered_map<std::string, double> table_sizes;
+    const AbstractLQPNode* plan = nullptr;
+    for (auto i = 0; i < table_count; ++i) {
+        auto index = i % 2 == 0 ? i / 2 : table_count / 2 + i / 2;
+        auto name = "tbl_" + std::to_string(index);
+        table_sizes.emplace(name, 100 + index);
+        const auto& table = lqp.make_node<StoredTableNode>(name);
+        plan = plan ? static_cast<const AbstractLQPNode*>(&lqp.make_node<JoinNode>(*plan, table)) : &table;
+    }
+    for (auto i = 1; i < table_count; ++i) {
+        auto predicate = "tbl_" + std::to_string(i - 1) + ".x = tbl_" + std::to_string(i) + ".x";
+        plan = &lqp.make_node<PredicateNode>(predicate, *plan);
+    }
+    lqp.set_root(*plan);
+
+    TableSizeEstimator estimator(table_sizes);
+    auto graph = extract_join_graph(lqp, lqp.get_root(), estimator);
+    ASSERT_EQ(graph.relations.size(), table_count);
+    auto tree = GreedyJoinEnumerator(graph).enumerate();
+    ASSERT_EQ(tree.joins.size(), table_count - 1);
+    auto cost = estimate_join_tree_cost(graph, tree);
+    EXPECT_LT(cost, estimate_join_tree_cost(graph, graph.current_tree));
+
+    JoinOrderingRule rule(std::make_unique<TableSizeEstimator>(estimator));
+    rule.apply(lqp, 0);
+    EXPECT_EQ(lqp.get_node_count(), 2 * table_count - 1);
+    EXPECT_DOUBLE_EQ(get_block_cost(lqp, estimator), cost);
+
+    auto generation = lqp.get_generation();
+    rule.apply(lqp, 0);
+    EXPECT_EQ(lqp.get_generation(), generation);
+}
+
+TEST(JoinOrdering, SelectsGreedyOrderingAboveThreshold) {
+    // Same star as in JoinsSmallestDimensionsFirst, plus a disconnected table crossed last as it is the largest.
+    LQP lqp;
+    const auto& joins = lqp.make_node<JoinNode>(lqp.make_node<JoinNode>(lqp.make_node<JoinNode>(lqp.make_node<JoinNode>(
+            lqp.make_node<StoredTableNode>("dim_c"), lqp.make_node<StoredTableNode>("other")),
+            lqp.make_node<StoredTableNode>("dim_b")), lqp.make_node<StoredTableNode>("dim_a")),
+            lqp.make_node<StoredTableNode>("fact"));
+    lqp.set_root(lqp.make_node<PredicateNode>("fact.a = dim_a.a",
+            lqp.make_node<PredicateNode>("fact.b = dim_b.b", lqp.make_node<PredicateNode>("fact.c = dim_c.c", joins))));
+
+    EXPECT_THROW(JoinOrderingRule(std::make_unique<HeuristicCardinalityEstimator>(), DPccpJoinEnumerator::max_relations + 1),
+                 std::logic_error);
+    JoinOrderingRule rule(std::make_unique<TableSizeEstimator>(std::unordered_map<std::string, double>{
+            { "fact", 1'000'000 }, { "dim_a", 10 }, { "dim_b", 100 }, { "dim_c", 1000 }, { "other", 1'000'000'000 } }), 2);
+    rule.apply(lqp, 0);
+
+    LQP expected_lqp;
+    const auto& expected_a = expected_lqp.make_node<JoinNode>(JoinMode::Inner, "fact.a = dim_a.a",
+            expected_lqp.make_node<StoredTableNode>("fact"), expected_lqp.make_node<StoredTableNode>("dim_a"));
+    const auto& expected_b = expected_lqp.make_node<JoinNode>(JoinMode::Inner, "fact.b = dim_b.b",
+            expected_a, expected_lqp.make_node<StoredTableNode>("dim_b"));
+    const auto& expected_c = expected_lqp.make_node<JoinNode>(JoinMode::Inner, "fact.c = dim_c.c",
+            expected_b, expected_lqp.make_node<StoredTableNode>("dim_c"));
+    expected_lqp.set_root(expected_lqp.make_node<JoinNode>(expected_lqp.make_node<StoredTableNode>("other"), expected_c));
+    EXPECT_TRUE(structurally_equal(lqp.get_root(), expected_lqp.get_root()));
+}
@@ -0,0 +1,170 @@
+#include "gtest/gtest.h"
+
+#include "lqp_batch.hpp"
+#include "lqp_nodes.hpp"
+
+namespace {
+
+/// [Predicate a > 1]
+///  \_[Join]
+///     \_[StoredTable tbl_a]
+///     \_[StoredTable tbl_b]
+const JoinNode& make_plan(LQP& lqp) {
+    const auto& join = lqp.make_node<JoinNode>(lqp.make_node<StoredTableNode>("tbl_a"), lqp.make_node<StoredTableNode>("tbl_b"));
+    lqp.set_root(lqp.make_node<PredicateNode>("a > 1", join));
+    return join;
+}
+
+} // namespace
+
+TEST(LQPMutationBatch, DefersIndexUpdatesUntilCommit) {
+    LQP lqp;
+    const auto& join = make_plan(lqp);
+    const auto& tbl_a = join.get_input_nodes()[0];
+    const auto& tbl_b = join.get_input_nodes()[1];
+    const auto& predicate = static_cast<const PredicateNode&>(lqp.get_root());
+    auto generation = lqp.get_generation();
+    auto node_count = lqp.get_node_count();
+
+    LQPMutationBatch batch(lqp);
+    const auto& filter = batch.wrap_node_with<PredicateNode>(tbl_b, "tbl_b.y < 2");
+    batch.bypass_node(predicate);
+    batch.replace_input(join, tbl_a, batch.make_node<StoredTableNode>("tbl_c"));
+    batch.remove_node(tbl_a);
+
+    // Inputs change immediately, the parent index of the LQP only on commit, except for the links of new nodes.
+    EXPECT_EQ(&join.get_input_nodes()[1], &filter);
+    EXPECT_EQ(lqp.get_parent_count(tbl_b), 2);
+    EXPECT_EQ(batch.get_parents(tbl_b), (std::vector<const AbstractLQPNode*>{ &filter }));
+    EXPECT_EQ(batch.get_parent_count(tbl_a), 0);
+    EXPECT_EQ(lqp.get_parent_count(tbl_a), 1);
+
+    auto commit_generation = lqp.get_generation();
+    batch.commit();
+    EXPECT_GT(lqp.get_generation(), commit_generation);
+    EXPECT_EQ(lqp.get_node_count(), node_count);
+    EXPECT_EQ(&lqp.get_root(), &join);
+    EXPECT_EQ(lqp.get_parent_count(tbl_b), 1);
+    EXPECT_EQ((*lqp.get_parents(tbl_b).begin()).second, &filter);
+    EXPECT_EQ(lqp.get_parent_count(filter), 1);
+    EXPECT_TRUE(lqp.subplan_changed_since(join, commit_generation));
+    EXPECT_FALSE(lqp.subplan_changed_since(tbl_b, generation));
+
+    LQP expected_lqp;
+    expected_lqp.set_root(expected_lqp.make_node<JoinNode>(
+            expected_lqp.make_node<StoredTableNode>("tbl_c"),
+            expected_lqp.make_node<PredicateNode>("tbl_b.y < 2", expected_lqp.make_node<StoredTableNode>("tbl_b"))));
+    EXPECT_TRUE(structurally_equal(lqp.get_root(), expected_lqp.get_root()));
+    EXPECT_THROW(batch.remove_node(join), std::logic_error);
+}
+
+TEST(LQPMutationBatch, RollsBackUncommittedChanges) {
+    LQP lqp;
+    const auto& join = make_plan(lqp);
+    LQP original;
+    make_plan(original);
+    auto node_count = lqp.get_node_count();
+
+    {
+        LQPMutationBatch batch(lqp);
+        const auto& tbl_c = batch.make_node<StoredTableNode>("tbl_c");
+        batch.replace_node(join.get_input_nodes()[0], batch.make_node<PredicateNode>("c > 1", tbl_c));
+        batch.wrap_node_with<PredicateNode>(lqp.get_root(), "b > 1");
+        batch.bypass_node(static_cast<const PredicateNode&>(join.get_input_nodes()[0]));
+    }
+    EXPECT_EQ(lqp.get_node_count(), node_count);
+    EXPECT_TRUE(structurally_equal(lqp.get_root(), original.get_root()));
+    EXPECT_EQ(lqp.get_parent_count(join), 1);
+    EXPECT_EQ(lqp.get_parent_count(join.get_input_nodes()[0]), 1);
+}
+
+TEST(LQPMutationBatch, RollsBackOnInvariantViolation) {
+    LQP lqp;
+    const auto& join = make_plan(lqp);
+    LQP original;
+    make_plan(original);
+    auto generation = lqp.get_generation();
+
+    // The join still has the root as a parent.
+    LQPMutationBatch batch(lqp);
+    batch.wrap_node_with<PredicateNode>(join.get_input_nodes()[0], "tbl_a.x > 1");
+    batch.remove_node(join);
+    EXPECT_THROW(batch.commit(), std::logic_error);
+    EXPECT_TRUE(structurally_equal(lqp.get_root(), original.get_root()));
+    EXPECT_EQ(lqp.get_node_count(), original.get_node_count());
+
+    // Failing eager checks leave the batch usable.
+    LQPMutationBatch other_batch(lqp);
+    EXPECT_THROW(other_batch.replace_input(join, join.get_input_nodes()[0], join.get_input_nodes()[1]),
+                 std::logic_error);
+    const auto& unused = other_batch.make_node<StoredTableNode>("tbl_c");
+    other_batch.remove_node(unused);
+    EXPECT_THROW(other_batch.remove_node(unused), std::logic_error);
+    other_batch.commit();
+    EXPECT_GT(lqp.get_generation(), generation);
+    EXPECT_TRUE(structurally_equal(lqp.get_root(), original.get_root()));
+}
+
+TEST(LQPMutationBatch, RollsBackRemovalsOfReferencedAndForeignNodes) {
+    LQP lqp;
+    const auto& join = make_plan(lqp);
+    const auto& tbl_b = join.get_input_nodes()[1];
+    LQP original;
+    make_plan(original);
+    auto node_count = lqp.get_node_count();
+
+    {
+        auto ref = tbl_b.get_node_ref();
+        LQPMutationBatch batch(lqp);
+        batch.replace_node(tbl_b, batch.make_node<StoredTableNode>("tbl_c"));
+        batch.remove_node(tbl_b);
+        EXPECT_THROW(batch.commit(), std::logic_error);
+    }
+    EXPECT_EQ(lqp.get_node_count(), node_count);
+    EXPECT_TRUE(structurally_equal(lqp.get_root(), original.get_root()));
+    EXPECT_EQ(lqp.get_parent_count(tbl_b), 1);
+
+    LQPMutationBatch batch(lqp);
+    batch.remove_node(original.get_root());
+    EXPECT_THROW(batch.commit(), std::logic_error);
+    EXPECT_EQ(lqp.get_node_count(), node_count);
+    EXPECT_EQ(original.get_node_count(), node_count);
+    EXPECT_TRUE(structurally_equal(lqp.get_root(), original.get_root()));
+}
+
+TEST(LQPMutationBatch, RemovesSubplans) {
+    LQP lqp;
+    const auto& join = make_plan(lqp);
+    const auto& tbl_a = join.get_input_nodes()[0];
+    const auto& tbl_b = join.get_input_nodes()[1];
+
+    // Inputs may be removed before their parents.
+    LQPMutationBatch batch(lqp);
+    batch.set_root(batch.make_node<StoredTableNode>("tbl_c"));
+    batch.remove_node(tbl_b);
+    batch.remove_node(join);
+    batch.remove_node(tbl_a);
+    batch.remove_node(*(*lqp.get_parents(join).begin()).second);
+    // All changes, including the removals, are made in a single generation.
+    auto generation = lqp.get_generation();
+    batch.commit();
+    EXPECT_EQ(lqp.get_generation(), generation + 1);
+    EXPECT_EQ(lqp.get_node_count(), 1);
+    EXPECT_EQ(static_cast<const StoredTableNode&>(lqp.get_root()).get_name(), "tbl_c");
+}
+
+TEST(LQPMutationBatch, MarksInputsThatLostParents) {
+    LQP lqp;
+    const auto& table = lqp.make_node<StoredTableNode>("tbl_a");
+    const auto& left = lqp.make_node<PredicateNode>("a > 1", table);
+    const auto& right = lqp.make_node<PredicateNode>("a < 2", table);
+    lqp.set_root(lqp.make_node<JoinNode>(left, right));
+    auto generation = lqp.get_generation();
+
+    LQPMutationBatch batch(lqp);
+    batch.replace_input(right, table, batch.make_node<StoredTableNode>("tbl_b"));
+    batch.commit();
+    EXPECT_EQ(lqp.get_parent_count(table), 1);
+    EXPECT_TRUE(lqp.subplan_changed_since(table, generation));
+    EXPECT_TRUE(lqp.subplan_changed_since(left, generation));
+}
@@ -0,0 +1,121 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lqp_nodes.hpp"
+#include "lqp_snapshot.hpp"
+
+TEST(LQPSnapshot, SharesSnapshotsUntilMutation) {
+    LQP lqp;
+    const auto& table = lqp.make_node<StoredTableNode>("tbl_a");
+    lqp.set_root(lqp.make_node<PredicateNode>("tbl_a.x > 1", table));
+
+    LQPSnapshotPublisher publisher(lqp);
+    EXPECT_EQ(publisher.get(), nullptr);
+    auto snapshot = publisher.publish();
+    EXPECT_EQ(publisher.publish(), snapshot);
+    EXPECT_EQ(publisher.get(), snapshot);
+    EXPECT_EQ(snapshot->get_generation(), lqp.get_generation());
+    EXPECT_EQ(snapshot->get_lqp().get_node_count(), 2);
+    EXPECT_TRUE(structurally_equal(snapshot->get_root(), lqp.get_root()));
+
+    // Mutations are not visible in published snapshots.
+    lqp.wrap_node_with<PredicateNode>(table, "tbl_a.y < 2");
+    EXPECT_EQ(publisher.get(), snapshot);
+    auto next_snapshot = publisher.publish();
+    EXPECT_NE(next_snapshot, snapshot);
+    EXPECT_EQ(next_snapshot->get_lqp().get_node_count(), 3);
+    EXPECT_TRUE(structurally_equal(next_snapshot->get_root(), lqp.get_root()));
+    EXPECT_FALSE(structurally_equal(snapshot->get_root(), lqp.get_root()));
+}
+
+TEST(LQPSnapshot, OutlivesSource) {
+    std::shared_ptr<const LQPSnapshot> snapshot;
+    {
+        // Shared nodes are copied once.
+        LQP lqp;
+        const auto& shared = lqp.make_node<PredicateNode>("tbl_a.x > 1", lqp.make_node<StoredTableNode>("tbl_a"));
+        lqp.set_root(lqp.make_node<JoinNode>(shared, lqp.make_node<PredicateNode>("tbl_a.y > 1", shared)));
+        snapshot = LQPSnapshotPublisher(lqp).publish();
+    }
+    const auto& root = snapshot->get_root();
+    EXPECT_EQ(snapshot->get_lqp().get_node_count(), 4);
+    EXPECT_EQ(&root.get_input_nodes()[0], &root.get_input_nodes()[1].get_input_nodes()[0]);
+}
+
+TEST(LQPSnapshot, CopiesNodesReachableFromTheRoot) {
+    // The detached predicate is left over from a rewrite and not part of the plan.
+    LQP lqp;
+    const auto& table = lqp.make_node<StoredTableNode>("tbl_a");
+    static_cast<void>(lqp.make_node<PredicateNode>("tbl_a.y > 1", table));
+    lqp.set_root(lqp.make_node<PredicateNode>("tbl_a.x > 1", table));
+
+    auto snapshot = LQPSnapshotPublisher(lqp).publish();
+    const auto& snapshot_lqp = snapshot->get_lqp();
+    EXPECT_EQ(snapshot_lqp.get_node_count(), 2);
+    const auto& snapshot_table = snapshot->get_root().get_input_nodes()[0];
+    ASSERT_EQ(snapshot_lqp.get_parent_count(snapshot_table), 1);
+    EXPECT_EQ((*snapshot_lqp.get_parents(snapshot_table).begin()).second, &snapshot->get_root());
+    EXPECT_LT(snapshot_lqp.get_expression_pool().size(), lqp.get_expression_pool().size());
+}
+
+TEST(LQPSnapshot, ReadsConcurrentlyWithMutations) {
+    // [Join]
+    //  \_[Join]
+    //  |  \_[StoredTable tbl_0]
+    //  |  \_[StoredTable tbl_1]
+    //  \_ ...
+    LQP lqp;
+    constexpr auto table_count = 8;
+    std::vector<const StoredTableNode*> tables;
+    const AbstractLQPNode* plan = &lqp.make_node<StoredTableNode>("tbl_0");
+    tables.push_back(static_cast<const StoredTableNode*>(plan));
+    for (auto i = 1; i < table_count; ++i) {
+        tables.push_back(&lqp.make_node<StoredTableNode>("tbl_" + std::to_string(i)));
+        plan = &lqp.make_node<JoinNode>(*plan, *tables.back());
+    }
+    lqp.set_root(*plan);
+
+    LQPSnapshotPublisher publisher(lqp);
+    publisher.publish();
+    std::atomic<bool> done = false;
+    std::vector<std::thread> readers;
+    std::atomic<int> failures = 0;
+    for (auto i = 0; i < 4; ++i) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                // Every snapshot has all tables, each wrapped by at most one predicate.
+                auto snapshot = publisher.get();
+                auto table_count_seen = 0;
+                snapshot->get_lqp().visit(snapshot->get_root(), [&](const AbstractLQPNode& node) {
+                    if (node.type == LQPNodeType::StoredTable) ++table_count_seen;
+                });
+                auto node_count = snapshot->get_lqp().get_node_count();
+                if (table_count_seen != table_count || node_count < 2 * table_count - 1
+                    || node_count > 3 * table_count - 1 || snapshot->get_root().get_structural_hash() == 0) {
+                    ++failures;
+                }
+            }
+        });
+    }
+
+    for (auto round = 0; round < 200; ++round) {
+        for (auto table : tables) {
+            lqp.bypass_node(lqp.wrap_node_with<PredicateNode>(*table, "tbl_0.x > 1"));
+            lqp.wrap_node_with<PredicateNode>(*table, "tbl_0.x > 1");
+            publisher.publish();
+        }
+        for (auto table : tables) {
+            lqp.bypass_node(static_cast<const PredicateNode&>(*(*lqp.get_parents(*table).begin()).second));
+            publisher.publish();
+        }
+    }
+    done = true;
+    for (auto& reader : readers) reader.join();
+    EXPECT_EQ(failures.load(), 0);
+    EXPECT_TRUE(structurally_equal(publisher.get()->get_root(), lqp.get_root()));
+}
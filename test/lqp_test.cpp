@@ -0,0 +1,375 @@
+#include "gtest/gtest.h"
+
+#include "lqp.hpp"
+#include "lqp_copy.hpp"
+#include "lqp_nodes.hpp"
+
+TEST(LQP, AssignsDenseIds) {
+    LQP lqp;
+    const auto& tbl_a = lqp.make_node<StoredTableNode>("tbl_a");
+    const auto& tbl_b = lqp.make_node<StoredTableNode>("tbl_b");
+    const auto& join = lqp.make_node<JoinNode>(tbl_a, tbl_b);
+    lqp.set_root(join);
+
+    EXPECT_EQ(tbl_a.get_id(), 0);
+    EXPECT_EQ(tbl_b.get_id(), 1);
+    EXPECT_EQ(join.get_id(), 2);
+    EXPECT_EQ(lqp.get_node_id_bound(), 3);
+    EXPECT_EQ(lqp.get_node_count(), 3);
+}
+
+TEST(LQP, RecyclesIdsOfBypassedNodes) {
+    LQP lqp;
+    const auto& tbl_a = lqp.make_node<StoredTableNode>("tbl_a");
+    const auto& join = lqp.make_node<JoinNode>(tbl_a, lqp.make_node<StoredTableNode>("tbl_b"));
+    lqp.set_root(join);
+
+    const auto& predicate = lqp.wrap_node_with<PredicateNode>(tbl_a, "a > 1");
+    auto predicate_id = predicate.get_id();
+    EXPECT_EQ(predicate_id, 3);
+    lqp.bypass_node(predicate);
+    EXPECT_EQ(lqp.get_node_count(), 3);
+
+    // The freed id is handed out again instead of growing the id range.
+    const auto& new_predicate = lqp.wrap_node_with<PredicateNode>(tbl_a, "a > 2");
+    EXPECT_EQ(new_predicate.get_id(), predicate_id);
+    EXPECT_EQ(lqp.get_node_id_bound(), 4);
+}
+
+TEST(LQP, RecyclesIdsOfRemovedNodes) {
+    LQP lqp;
+    lqp.set_root(lqp.make_node<StoredTableNode>("tbl_a"));
+    const auto& detached = lqp.make_node<StoredTableNode>("tbl_b");
+    auto detached_id = detached.get_id();
+    lqp.remove_node(detached);
+    EXPECT_EQ(lqp.get_node_count(), 1);
+    EXPECT_EQ(lqp.make_node<StoredTableNode>("tbl_c").get_id(), detached_id);
+
+    // Nodes of other LQPs are rejected even if their id is in range.
+    LQP other;
+    const auto& foreign = other.make_node<StoredTableNode>("tbl_d");
+    other.set_root(foreign);
+    EXPECT_THROW(lqp.remove_node(foreign), std::logic_error);
+
+    // The check precedes any change to the LQP, even if the ids of the foreign node's inputs are in range.
+    const auto& foreign_predicate = other.make_node<PredicateNode>("x > 1", foreign);
+    auto generation = lqp.get_generation();
+    EXPECT_THROW(lqp.remove_node(foreign_predicate), std::logic_error);
+    EXPECT_THROW(lqp.bypass_node(foreign_predicate), std::logic_error);
+    EXPECT_EQ(lqp.get_generation(), generation);
+    EXPECT_EQ(other.get_parent_count(foreign), 1);
+}
+
+TEST(LQP, RejectsNodesUsingAnInputTwice) {
+    LQP lqp;
+    const auto& table = lqp.make_node<StoredTableNode>("tbl_a");
+    EXPECT_THROW(static_cast<void>(lqp.make_node<JoinNode>(table, table)), std::logic_error);
+    EXPECT_EQ(lqp.get_node_count(), 1);
+    EXPECT_EQ(lqp.get_parent_count(table), 0);
+}
+
+TEST(LQP, BuildsWidelySharedNodes) {
+    // Adding a parent does not scan the existing parents of the input.
+    constexpr auto parent_count = 100'000;
+    LQP lqp;
+    const auto& table = lqp.make_node<StoredTableNode>("tbl");
+    for (auto i = 0; i < parent_count; ++i) static_cast<void>(lqp.make_node<PredicateNode>("p", table));
+    EXPECT_EQ(lqp.get_parent_count(table), parent_count);
+}
+
+TEST(LQP, ListsInputsWithoutAllocating) {
+    LQP lqp;
+    const auto& tbl_a = lqp.make_node<StoredTableNode>("tbl_a");
+    const auto& tbl_b = lqp.make_node<StoredTableNode>("tbl_b");
+    const auto& join = lqp.make_node<JoinNode>(tbl_a, tbl_b);
+    const auto& predicate = lqp.make_node<PredicateNode>("a > 1", join);
+    lqp.set_root(predicate);
+
+    EXPECT_TRUE(tbl_a.get_input_nodes().empty());
+    ASSERT_EQ(predicate.get_input_nodes().size(), 1);
+    EXPECT_EQ(&predicate.get_input_nodes()[0], &join);
+
+    auto join_inputs = join.get_input_nodes();
+    ASSERT_EQ(join_inputs.size(), 2);
+    EXPECT_EQ(&join_inputs[0], &tbl_a);
+    EXPECT_EQ(&join_inputs[1], &tbl_b);
+
+    // The vector wrapper lists the same inputs.
+    auto join_input_vector = join.get_inputs();
+    ASSERT_EQ(join_input_vector.size(), 2);
+    EXPECT_EQ(&join_input_vector[1].get(), &tbl_b);
+}
+
+namespace {
+
+/// Join of a table with itself through two predicates, so the table is reachable via two paths.
+///
+/// [Join]
+///  \_[Predicate a]
+///  |  \_[StoredTable]
+///  \_[Predicate b]
+///     \_[StoredTable] (same node)
+const AbstractLQPNode& make_diamond(LQP& lqp) {
+    const auto& table = lqp.make_node<StoredTableNode>("tbl");
+    const auto& join = lqp.make_node<JoinNode>(
+            lqp.make_node<PredicateNode>("a", table),
+            lqp.make_node<PredicateNode>("b", table));
+    lqp.set_root(join);
+    return table;
+}
+
+} // namespace
+
+TEST(LQP, VisitsInPreOrderAndPostOrder) {
+    LQP lqp;
+    const auto& table = lqp.make_node<StoredTableNode>("tbl_a");
+    const auto& predicate = lqp.make_node<PredicateNode>("a > 1", table);
+    const auto& other_table = lqp.make_node<StoredTableNode>("tbl_b");
+    const auto& join = lqp.make_node<JoinNode>(predicate, other_table);
+    lqp.set_root(join);
+
+    std::vector<const AbstractLQPNode*> pre_order;
+    lqp.visit(join, [&](const AbstractLQPNode& node) { pre_order.push_back(&node); });
+    EXPECT_EQ(pre_order, (std::vector<const AbstractLQPNode*>{&join, &predicate, &table, &other_table}));
+
+    std::vector<const AbstractLQPNode*> post_order;
+    lqp.visit<LQP::VisitOrder::PostOrder>(join, [&](const AbstractLQPNode& node) { post_order.push_back(&node); });
+    EXPECT_EQ(post_order, (std::vector<const AbstractLQPNode*>{&table, &predicate, &other_table, &join}));
+
+    // Returning false skips the inputs.
+    std::vector<const AbstractLQPNode*> pruned;
+    lqp.visit(join, [&](const AbstractLQPNode& node) {
+        pruned.push_back(&node);
+        return node.type != LQPNodeType::Predicate;
+    });
+    EXPECT_EQ(pruned, (std::vector<const AbstractLQPNode*>{&join, &predicate, &other_table}));
+}
+
+TEST(LQP, VisitsSharedNodesOnce) {
+    LQP lqp;
+    const auto& table = make_diamond(lqp);
+
+    auto count_table_visits = [&table](int& count) {
+        return [&table, &count](const AbstractLQPNode& node) { count += &node == &table; };
+    };
+
+    auto pre_order_visits = 0;
+    lqp.visit(lqp.get_root(), count_table_visits(pre_order_visits));
+    EXPECT_EQ(pre_order_visits, 2);
+
+    auto pre_order_once_visits = 0;
+    lqp.visit<LQP::VisitOrder::PreOrder, LQP::SharedNodes::VisitOnce>(
+            lqp.get_root(), count_table_visits(pre_order_once_visits));
+    EXPECT_EQ(pre_order_once_visits, 1);
+
+    auto post_order_once_visits = 0;
+    lqp.visit<LQP::VisitOrder::PostOrder, LQP::SharedNodes::VisitOnce>(
+            lqp.get_root(), count_table_visits(post_order_once_visits));
+    EXPECT_EQ(post_order_once_visits, 1);
+}
+
+TEST(LQP, PassesStateDownEachPath) {
+    LQP lqp;
+    const auto& table = lqp.make_node<StoredTableNode>("tbl_a");
+    const auto& join = lqp.make_node<JoinNode>(lqp.make_node<PredicateNode>("a > 1", table),
+                                               lqp.make_node<StoredTableNode>("tbl_b"));
+    lqp.set_root(join);
+
+    std::vector<int> depths;
+    lqp.visit<int>(join, [&](const AbstractLQPNode&, int& depth) {
+        depths.push_back(depth++);
+        return true;
+    }, 0);
+    EXPECT_EQ(depths, (std::vector<int>{0, 1, 2, 1}));
+}
+
+TEST(LQP, VisitsDeepPlansWithoutRecursion) {
+    constexpr auto depth = 100'000;
+    LQP lqp;
+    const AbstractLQPNode* plan = &lqp.make_node<StoredTableNode>("tbl");
+    for (auto i = 0; i < depth; ++i) plan = &lqp.make_node<PredicateNode>("p", *plan);
+    lqp.set_root(*plan);
+
+    auto count = 0;
+    lqp.visit<LQP::VisitOrder::PostOrder>(*plan, [&count](const AbstractLQPNode&) { ++count; });
+    EXPECT_EQ(count, depth + 1);
+}
+
+TEST(LQP, DestroysSharedAndDetachedNodes) {
+    auto lqp = std::make_unique<LQP>();
+    make_diamond(*lqp);
+    const auto& table = lqp->make_node<StoredTableNode>("tbl_b");
+    std::ignore = lqp->make_node<PredicateNode>("detached", table);
+
+    // Destruction terminates on dangling references, so reaching the end suffices.
+    lqp.reset();
+    LQP empty_lqp;
+}
+
+namespace {
+
+const AbstractLQPNode& make_join_plan(LQP& lqp, const std::string& predicate) {
+    const auto& join = lqp.make_node<JoinNode>(
+            lqp.make_node<PredicateNode>(predicate, lqp.make_node<StoredTableNode>("tbl_a")),
+            lqp.make_node<StoredTableNode>("tbl_b"));
+    lqp.set_root(join);
+    return join;
+}
+
+} // namespace
+
+TEST(LQP, ComparesPlansStructurally) {
+    LQP lqp_a, lqp_b, lqp_c;
+    const auto& plan_a = make_join_plan(lqp_a, "a > 1");
+    const auto& plan_b = make_join_plan(lqp_b, "a > 1");
+    const auto& plan_c = make_join_plan(lqp_c, "a > 2");
+
+    EXPECT_EQ(plan_a.get_structural_hash(), plan_b.get_structural_hash());
+    EXPECT_TRUE(structurally_equal(plan_a, plan_b));
+    EXPECT_NE(plan_a.get_structural_hash(), plan_c.get_structural_hash());
+    EXPECT_FALSE(structurally_equal(plan_a, plan_c));
+
+    // Swapped join inputs are a different plan.
+    LQP lqp_d;
+    const auto& tbl_b = lqp_d.make_node<StoredTableNode>("tbl_b");
+    const auto& plan_d = lqp_d.make_node<JoinNode>(
+            tbl_b, lqp_d.make_node<PredicateNode>("a > 1", lqp_d.make_node<StoredTableNode>("tbl_a")));
+    lqp_d.set_root(plan_d);
+    EXPECT_FALSE(structurally_equal(plan_a, plan_d));
+}
+
+TEST(LQP, ComparesSharedSubplansOnce) {
+    // Ladder of diamonds: each join reads the previous one through two predicates, so a walk over all paths visits
+    // 2^64 nodes.
+    auto make_ladder = [](LQP& lqp) -> const AbstractLQPNode& {
+        const AbstractLQPNode* plan = &lqp.make_node<StoredTableNode>("tbl_a");
+        for (auto i = 0; i < 64; ++i) {
+            plan = &lqp.make_node<JoinNode>(lqp.make_node<PredicateNode>("a > 1", *plan),
+                                            lqp.make_node<PredicateNode>("a < 2", *plan));
+        }
+        lqp.set_root(*plan);
+        return *plan;
+    };
+    LQP lqp_a, lqp_b;
+    EXPECT_TRUE(structurally_equal(make_ladder(lqp_a), make_ladder(lqp_b)));
+}
+
+TEST(LQP, DistinguishesJoinModesAndConditions) {
+    LQP lqp;
+    const auto& tbl_a = lqp.make_node<StoredTableNode>("tbl_a");
+    const auto& tbl_b = lqp.make_node<StoredTableNode>("tbl_b");
+    const auto& join = lqp.make_node<JoinNode>(JoinMode::Left, "tbl_a.x = tbl_b.x AND tbl_a.y < tbl_b.y AND tbl_a.z = tbl_b.z",
+                                               tbl_a, tbl_b);
+    EXPECT_EQ(join.get_mode(), JoinMode::Left);
+    ASSERT_EQ(join.get_equi_conditions().size(), 2);
+    EXPECT_EQ(to_string(*join.get_equi_conditions()[1]), "tbl_a.z = tbl_b.z");
+    ASSERT_EQ(join.get_theta_conditions().size(), 1);
+    EXPECT_EQ(to_string(*join.get_theta_conditions()[0]), "tbl_a.y < tbl_b.y");
+
+    // A join without a condition is a cross product.
+    const auto& cross_product = lqp.make_node<JoinNode>(tbl_a, tbl_b);
+    EXPECT_EQ(cross_product.get_condition(), nullptr);
+    EXPECT_TRUE(cross_product.get_equi_conditions().empty());
+
+    LQP other;
+    const auto& other_a = other.make_node<StoredTableNode>("tbl_a");
+    const auto& other_b = other.make_node<StoredTableNode>("tbl_b");
+    EXPECT_TRUE(structurally_equal(join, other.make_node<JoinNode>(
+            JoinMode::Left, join.get_condition(), other_a, other_b)));
+    EXPECT_FALSE(structurally_equal(join, other.make_node<JoinNode>(
+            JoinMode::Semi, join.get_condition(), other_a, other_b)));
+    EXPECT_FALSE(structurally_equal(join, other.make_node<JoinNode>(JoinMode::Left, "tbl_a.x = tbl_b.x", other_a, other_b)));
+    EXPECT_FALSE(structurally_equal(join, other.make_node<JoinNode>(other_a, other_b)));
+    EXPECT_TRUE(structurally_equal(cross_product, other.make_node<JoinNode>(other_a, other_b)));
+}
+
+TEST(LQP, InvalidatesStructuralHashesOnMutation) {
+    LQP lqp, expected_lqp;
+    const auto& plan = make_join_plan(lqp, "a > 1");
+    const auto& expected_plan = expected_lqp.make_node<JoinNode>(
+            expected_lqp.make_node<PredicateNode>("a > 1", expected_lqp.make_node<StoredTableNode>("tbl_a")),
+            expected_lqp.make_node<PredicateNode>("b > 1", expected_lqp.make_node<StoredTableNode>("tbl_b")));
+    expected_lqp.set_root(expected_plan);
+
+    auto original_hash = plan.get_structural_hash();
+    const auto& tbl_b = plan.get_input_nodes()[1];
+    const auto& predicate = lqp.wrap_node_with<PredicateNode>(tbl_b, "b > 1");
+    EXPECT_NE(plan.get_structural_hash(), original_hash);
+    EXPECT_TRUE(structurally_equal(plan, expected_plan));
+
+    lqp.bypass_node(predicate);
+    EXPECT_EQ(plan.get_structural_hash(), original_hash);
+    EXPECT_FALSE(structurally_equal(plan, expected_plan));
+}
+
+TEST(LQP, KeepsRootWhenWrappingOrBypassingIt) {
+    LQP lqp;
+    const auto& table = lqp.make_node<StoredTableNode>("tbl_a");
+    lqp.set_root(table);
+
+    const auto& predicate = lqp.wrap_node_with<PredicateNode>(table, "a > 1");
+    EXPECT_EQ(&lqp.get_root(), &predicate);
+
+    lqp.bypass_node(predicate);
+    EXPECT_EQ(&lqp.get_root(), &table);
+}
+
+TEST(LQP, TracksChangedSubplans) {
+    LQP lqp;
+    const auto& tbl_a = lqp.make_node<StoredTableNode>("tbl_a");
+    const auto& tbl_b = lqp.make_node<StoredTableNode>("tbl_b");
+    const auto& predicate = lqp.make_node<PredicateNode>("b > 1", tbl_b);
+    const auto& join = lqp.make_node<JoinNode>(tbl_a, predicate);
+    lqp.set_root(join);
+
+    auto generation = lqp.get_generation();
+    EXPECT_FALSE(lqp.subplan_changed_since(join, generation));
+
+    lqp.wrap_node_with<PredicateNode>(tbl_a, "a > 1");
+    EXPECT_GT(lqp.get_generation(), generation);
+    EXPECT_TRUE(lqp.subplan_changed_since(join, generation));
+    EXPECT_FALSE(lqp.subplan_changed_since(tbl_a, generation));
+    EXPECT_FALSE(lqp.subplan_changed_since(predicate, generation));
+}
+
+TEST(LQP, ClonesAllNodes) {
+    // [Join tbl_a.x = tbl_b.x]       [Predicate tbl_b.x > 1] (detached)
+    //  \_[Predicate tbl_a.y < 2]      \_[StoredTable tbl_b]
+    //  |  \_[StoredTable tbl_a]
+    //  \_[Projection tbl_b.x]
+    //     \_[StoredTable tbl_b]
+    LQP source;
+    const auto& removed = source.make_node<StoredTableNode>("removed");
+    const auto& tbl_b = source.make_node<StoredTableNode>("tbl_b");
+    const auto& join = source.make_node<JoinNode>(
+            JoinMode::Left, "tbl_a.x = tbl_b.x",
+            source.make_node<PredicateNode>("tbl_a.y < 2", source.make_node<StoredTableNode>("tbl_a")),
+            source.make_node<ProjectionNode>("tbl_b.x", tbl_b));
+    const auto& detached = source.make_node<PredicateNode>("tbl_b.x > 1", tbl_b);
+    source.remove_node(removed);
+    source.set_root(join);
+
+    LQP clone;
+    clone_lqp(clone, source);
+    EXPECT_EQ(clone.get_node_count(), source.get_node_count());
+    EXPECT_EQ(clone.get_node_id_bound(), source.get_node_count());
+    EXPECT_TRUE(structurally_equal(clone.get_root(), source.get_root()));
+    EXPECT_EQ(clone.get_expression_pool().size(), source.get_expression_pool().size());
+
+    // Shared nodes are copied once, with their parents in the same order.
+    const auto& cloned_tbl_b = clone.get_root().get_input_nodes()[1].get_input_nodes()[0];
+    ASSERT_EQ(clone.get_parent_count(cloned_tbl_b), 2);
+    std::vector<const AbstractLQPNode*> parents;
+    for (const auto& [_, parent] : clone.get_parents(cloned_tbl_b)) parents.push_back(parent);
+    EXPECT_EQ(parents[0], &clone.get_root().get_input_nodes()[1]);
+    EXPECT_TRUE(structurally_equal(*parents[1], detached));
+    EXPECT_EQ(clone.get_parent_count(*parents[1]), 0);
+    // Inputs precede their parents.
+    EXPECT_LT(cloned_tbl_b.get_id(), parents[0]->get_id());
+
+    // The clone is independent of the source.
+    clone.bypass_node(static_cast<const PredicateNode&>(clone.get_root().get_input_nodes()[0]));
+    EXPECT_FALSE(structurally_equal(clone.get_root(), source.get_root()));
+    EXPECT_EQ(source.get_node_count(), 6);
+    EXPECT_THROW(clone_lqp(clone, source), std::logic_error);
+}
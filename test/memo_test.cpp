@@ -0,0 +1,173 @@
+#include "gtest/gtest.h"
+
+#include "memo.hpp"
+#include "transformation_rules.hpp"
+
+namespace {
+
+std::vector<std::unique_ptr<AbstractTransformationRule>> make_join_rules() {
+    std::vector<std::unique_ptr<AbstractTransformationRule>> rules;
+    rules.push_back(std::make_unique<JoinCommutativityTransformation>());
+    rules.push_back(std::make_unique<JoinAssociativityTransformation>());
+    return rules;
+}
+
+} // namespace
+
+TEST(Memo, DeduplicatesExpressions) {
+    LQP lqp;
+    const auto& tbl_a = lqp.make_node<StoredTableNode>("tbl_a");
+    const auto& join = lqp.make_node<JoinNode>(tbl_a, lqp.make_node<StoredTableNode>("tbl_b"));
+    lqp.set_root(lqp.make_node<PredicateNode>("tbl_a.x = tbl_b.x", join));
+
+    LQP other;
+    other.set_root(other.make_node<JoinNode>(
+            other.make_node<StoredTableNode>("tbl_a"), other.make_node<StoredTableNode>("tbl_b")));
+
+    Memo memo;
+    auto root = memo.add_plan(lqp, lqp.get_root());
+    EXPECT_EQ(memo.get_group_count(), 4);
+    EXPECT_EQ(memo.add_plan(lqp, lqp.get_root()), root);
+    EXPECT_EQ(memo.add_plan(other, other.get_root()), memo.get_expression(memo.get_group_expressions(root)[0]).inputs[0]);
+    EXPECT_EQ(memo.add_plan(lqp, tbl_a), memo.add_plan(other, other.get_root().get_input_nodes()[0]));
+    EXPECT_EQ(memo.get_group_count(), 4);
+    EXPECT_EQ(memo.get_expression_count(), 4);
+    EXPECT_EQ(memo.get_tables(root), (std::vector<std::string>{ "tbl_a", "tbl_b" }));
+}
+
+TEST(Memo, ExploresAllJoinOrders) {
+    LQP lqp;
+    lqp.set_root(lqp.make_node<JoinNode>(
+            lqp.make_node<JoinNode>(lqp.make_node<StoredTableNode>("tbl_a"), lqp.make_node<StoredTableNode>("tbl_b")),
+            lqp.make_node<StoredTableNode>("tbl_c")));
+
+    Memo memo;
+    auto root = memo.add_plan(lqp, lqp.get_root());
+    memo.explore(make_join_rules());
+
+    // Three tables, three pairs and the root, whose six expressions are the ordered pairs of a pair and a table.
+    EXPECT_EQ(memo.get_distinct_group_count(), 7);
+    EXPECT_EQ(memo.get_group_expressions(root).size(), 6);
+    for (auto id : memo.get_group_expressions(root)) EXPECT_EQ(memo.get_expression(id).group, root);
+}
+
+TEST(Memo, MovesJoinConditionsWithTheirTables) {
+    // Join(Join(a, b) on a-b, c) on b-c and a-c: the b-c conjunct moves to Join(b, c) when regrouping.
+    LQP lqp;
+    lqp.set_root(lqp.make_node<JoinNode>(JoinMode::Inner, "tbl_b.y = tbl_c.y AND tbl_a.z = tbl_c.z",
+            lqp.make_node<JoinNode>(JoinMode::Inner, "tbl_a.x = tbl_b.x", lqp.make_node<StoredTableNode>("tbl_a"),
+                                    lqp.make_node<StoredTableNode>("tbl_b")),
+            lqp.make_node<StoredTableNode>("tbl_c")));
+
+    Memo memo;
+    auto root = memo.add_plan(lqp, lqp.get_root());
+    memo.explore(make_join_rules());
+
+    std::vector<std::string> conditions;
+    for (auto id : memo.get_group_expressions(root)) {
+        auto expression = memo.get_expression(id);
+        for (std::size_t i = 0; i < expression.input_count; ++i) {
+            for (auto input_id : memo.get_group_expressions(expression.inputs[i])) {
+                const auto& input = *memo.get_expression(input_id).node;
+                if (input.type != LQPNodeType::Join) continue;
+                conditions.push_back(to_string(*static_cast<const JoinNode&>(input).get_condition()));
+            }
+        }
+    }
+    EXPECT_NE(std::ranges::find(conditions, "tbl_b.y = tbl_c.y"), conditions.end());
+    EXPECT_NE(std::ranges::find(conditions, "tbl_a.z = tbl_c.z"), conditions.end());
+}
+
+TEST(Memo, KeepsOrderOfOuterJoins) {
+    LQP lqp;
+    lqp.set_root(lqp.make_node<JoinNode>(JoinMode::Left, "tbl_a.x = tbl_b.x", lqp.make_node<StoredTableNode>("tbl_a"),
+                                         lqp.make_node<StoredTableNode>("tbl_b")));
+
+    Memo memo;
+    auto root = memo.add_plan(lqp, lqp.get_root());
+    memo.explore(make_join_rules());
+    EXPECT_EQ(memo.get_group_expressions(root).size(), 1);
+}
+
+TEST(Memo, MergesEquivalentGroups) {
+    LQP lqp;
+    const auto& tbl_a = lqp.make_node<StoredTableNode>("tbl_a");
+    const auto& tbl_b = lqp.make_node<StoredTableNode>("tbl_b");
+    lqp.set_root(lqp.make_node<JoinNode>(tbl_a, tbl_b));
+    LQP swapped;
+    swapped.set_root(swapped.make_node<PredicateNode>("tbl_a.x = 1",
+            swapped.make_node<JoinNode>(swapped.make_node<StoredTableNode>("tbl_b"),
+                    swapped.make_node<StoredTableNode>("tbl_a"))));
+
+    // Both joins are added as separate groups, and the predicate above the second one gets a group of its own.
+    Memo memo;
+    auto join = memo.add_plan(lqp, lqp.get_root());
+    auto predicate = memo.add_plan(swapped, swapped.get_root());
+    auto swapped_join = memo.get_expression(memo.get_group_expressions(predicate)[0]).inputs[0];
+    EXPECT_NE(join, swapped_join);
+
+    memo.explore(make_join_rules());
+    EXPECT_EQ(memo.find(join), memo.find(swapped_join));
+    EXPECT_EQ(memo.get_distinct_group_count(), 4);
+    EXPECT_EQ(memo.get_group_expressions(join).size(), 2);
+    EXPECT_EQ(memo.get_expression(memo.get_group_expressions(predicate)[0]).inputs[0], memo.find(join));
+}
+
+TEST(Memo, ExtractsCheapestPlan) {
+    StatisticsCatalog catalog;
+    catalog.add_table("tbl_a", { 100'000, { { "x", { 1'000, 0, 1'000 } } } });
+    catalog.add_table("tbl_b", { 1'000, { { "x", { 1'000, 0, 1'000 } }, { "y", { 100, 0, 100 } } } });
+    catalog.add_table("tbl_c", { 100, { { "y", { 100, 0, 100 } } } });
+    CostModel cost_model(std::make_unique<CardinalityEstimator>(std::move(catalog)));
+
+    // A cross product of tbl_a and tbl_c, with all predicates on top.
+    LQP lqp;
+    const auto& join = lqp.make_node<JoinNode>(
+            lqp.make_node<JoinNode>(lqp.make_node<StoredTableNode>("tbl_a"), lqp.make_node<StoredTableNode>("tbl_c")),
+            lqp.make_node<StoredTableNode>("tbl_b"));
+    const auto& join_predicate = lqp.make_node<PredicateNode>("tbl_b.y = tbl_c.y",
+            lqp.make_node<PredicateNode>("tbl_a.x = tbl_b.x", join));
+    lqp.set_root(lqp.make_node<PredicateNode>("tbl_c.y < 10", join_predicate));
+    auto cost = cost_model.estimate_cost(lqp, lqp.get_root());
+
+    Memo memo;
+    auto root = memo.add_plan(lqp, lqp.get_root());
+    memo.explore(make_default_transformation_rules());
+    LQP optimized;
+    auto optimized_cost = memo.extract(root, cost_model, optimized);
+    EXPECT_LT(optimized_cost, cost);
+    EXPECT_DOUBLE_EQ(cost_model.estimate_cost(optimized, optimized.get_root()), optimized_cost);
+
+    // Every predicate sits directly above the join of the tables it references, or the table itself.
+    std::size_t predicate_count = 0;
+    const auto& optimized_root = optimized.get_root();
+    optimized.visit<LQP::VisitOrder::PreOrder, LQP::SharedNodes::VisitOnce>(optimized_root, [&](const AbstractLQPNode& node) {
+        if (node.type != LQPNodeType::Predicate) return;
+        ++predicate_count;
+        const auto& input = node.get_input_nodes()[0];
+        auto referenced_tables = get_referenced_table_names(static_cast<const PredicateNode&>(node).get_predicate());
+        if (referenced_tables.size() == 1) {
+            ASSERT_EQ(input.type, LQPNodeType::StoredTable);
+            EXPECT_EQ(static_cast<const StoredTableNode&>(input).get_name(), *referenced_tables.begin());
+        } else {
+            EXPECT_EQ(input.type, LQPNodeType::Join);
+        }
+    });
+    EXPECT_EQ(predicate_count, 3);
+}
+
+TEST(Memo, SharesExtractedGroups) {
+    LQP lqp;
+    const auto& scan = lqp.make_node<PredicateNode>("tbl_a.x < 10", lqp.make_node<StoredTableNode>("tbl_a"));
+    lqp.set_root(lqp.make_node<JoinNode>(scan, lqp.make_node<PredicateNode>("tbl_a.y < 10", scan)));
+
+    Memo memo;
+    auto root = memo.add_plan(lqp, lqp.get_root());
+    CostModel cost_model(std::make_unique<HeuristicCardinalityEstimator>());
+    LQP extracted;
+    memo.extract(root, cost_model, extracted);
+
+    EXPECT_EQ(extracted.get_node_count(), 4);
+    const auto& join = extracted.get_root();
+    EXPECT_EQ(&join.get_input_nodes()[0], &join.get_input_nodes()[1].get_input_nodes()[0]);
+}
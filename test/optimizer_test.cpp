@@ -0,0 +1,71 @@
+#include "gtest/gtest.h"
+
+#include "common_subplan_elimination.hpp"
+#include "lqp_nodes.hpp"
+#include "optimizer.hpp"
+
+namespace {
+
+/// Bypasses the topmost predicate on each application, so that a fixpoint takes one iteration per predicate.
+class BypassOnePredicateRule final : public AbstractRule {
+public:
+    [[nodiscard]] std::string_view name() const override { return "BypassOnePredicate"; }
+
+    void apply(LQP& lqp, std::uint64_t) override {
+        const PredicateNode* predicate = nullptr;
+        lqp.visit(lqp.get_root(), [&predicate](const AbstractLQPNode& node) {
+            if (predicate == nullptr && node.type == LQPNodeType::Predicate) {
+                predicate = static_cast<const PredicateNode*>(&node);
+            }
+            return predicate == nullptr;
+        });
+        if (predicate) lqp.bypass_node(*predicate);
+    }
+};
+
+} // namespace
+
+TEST(Optimizer, IteratesBatchesToFixpoint) {
+    LQP lqp;
+    const auto& table = lqp.make_node<StoredTableNode>("tbl_a");
+    lqp.set_root(lqp.make_node<PredicateNode>("c", lqp.make_node<PredicateNode>("b",
+            lqp.make_node<PredicateNode>("a", table))));
+
+    RuleBatch batch{ "Cleanup", 10 };
+    batch.rules.push_back(std::make_unique<BypassOnePredicateRule>());
+    batch.rules.push_back(std::make_unique<CommonSubplanEliminationRule>());
+    Optimizer optimizer;
+    optimizer.add_batch(std::move(batch));
+
+    auto report = optimizer.optimize(lqp);
+    EXPECT_EQ(&lqp.get_root(), &table);
+
+    ASSERT_EQ(report.batches.size(), 1);
+    EXPECT_EQ(report.batches[0].iterations, 4);
+    EXPECT_TRUE(report.batches[0].reached_fixpoint);
+
+    ASSERT_EQ(report.rules.size(), 2);
+    EXPECT_EQ(report.rules[0].rule_name, "BypassOnePredicate");
+    EXPECT_EQ(report.rules[0].applications, 4);
+    EXPECT_EQ(report.rules[0].changes, 3);
+    // Nothing changed after the last elimination in the fourth iteration.
+    EXPECT_EQ(report.rules[1].applications, 3);
+    EXPECT_EQ(report.rules[1].skipped, 1);
+    EXPECT_EQ(report.rules[1].changes, 0);
+}
+
+TEST(Optimizer, StopsAtIterationCap) {
+    LQP lqp;
+    lqp.set_root(lqp.make_node<PredicateNode>("b", lqp.make_node<PredicateNode>("a",
+            lqp.make_node<StoredTableNode>("tbl_a"))));
+
+    RuleBatch batch{ "Capped" };
+    batch.rules.push_back(std::make_unique<BypassOnePredicateRule>());
+    Optimizer optimizer;
+    optimizer.add_batch(std::move(batch));
+
+    auto report = optimizer.optimize(lqp);
+    EXPECT_EQ(report.batches[0].iterations, 1);
+    EXPECT_FALSE(report.batches[0].reached_fixpoint);
+    EXPECT_EQ(lqp.get_root().type, LQPNodeType::Predicate);
+}
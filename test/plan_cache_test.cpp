@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+
+#include "plan_cache.hpp"
+#include "predicate_pushdown.hpp"
+
+namespace {
+
+Optimizer make_optimizer() {
+    RuleBatch batch{ "Pushdown" };
+    batch.rules.push_back(std::make_unique<PredicatePushdownRule>());
+    Optimizer optimizer;
+    optimizer.add_batch(std::move(batch));
+    return optimizer;
+}
+
+/// Predicate over a join of tbl_a and tbl_b, filtering tbl_a by `filter`.
+void make_query(LQP& lqp, const std::string& filter) {
+    const auto& join = lqp.make_node<JoinNode>(
+            lqp.make_node<StoredTableNode>("tbl_a"), lqp.make_node<StoredTableNode>("tbl_b"));
+    lqp.set_root(lqp.make_node<PredicateNode>(filter, lqp.make_node<PredicateNode>("tbl_a.x = tbl_b.x", join)));
+}
+
+} // namespace
+
+TEST(PlanCache, ParameterizesConstants) {
+    ExpressionPool pool;
+    std::vector<const AbstractExpression*> parameters{ &parse_expression(pool, "'first'") };
+    const auto& predicate = parameterize_expression(
+            pool, parse_expression(pool, "t0.x < 1.5 AND t1.name = 'a b' OR t2.y > 10e3"), parameters);
+    EXPECT_EQ(to_string(predicate), "t0.x < $1 AND t1.name = $2 OR t2.y > $3");
+    ASSERT_EQ(parameters.size(), 4);
+    EXPECT_EQ(to_string(*parameters[3]), "10000");
+
+    // Binding into another pool imports the parameters.
+    ExpressionPool other_pool;
+    const auto& bound = bind_parameters(other_pool, predicate, parameters);
+    EXPECT_TRUE(other_pool.contains(bound));
+    EXPECT_EQ(to_string(bound), "t0.x < 1.5 AND t1.name = 'a b' OR t2.y > 10000");
+    EXPECT_THROW((void)bind_parameters(pool, parse_expression(pool, "t0.x < $4"), parameters), std::logic_error);
+}
+
+TEST(PlanCache, InstantiatesCachedPlans) {
+    auto optimizer = make_optimizer();
+    PlanCache cache(optimizer);
+
+    LQP first;
+    make_query(first, "tbl_a.y < 10");
+    LQP first_plan;
+    EXPECT_FALSE(cache.optimize(first, first_plan));
+
+    LQP second;
+    make_query(second, "tbl_a.y < 20");
+    LQP second_plan;
+    EXPECT_TRUE(cache.optimize(second, second_plan));
+    EXPECT_EQ(cache.get_statistics().hits, 1);
+    EXPECT_EQ(cache.get_statistics().misses, 1);
+    EXPECT_EQ(cache.get_entry_count(), 1);
+
+    // The filter is pushed onto tbl_a in both plans, with the literal of the respective query.
+    const auto& filter = second_plan.get_root().get_input_nodes()[0].get_input_nodes()[0];
+    ASSERT_EQ(filter.type, LQPNodeType::Predicate);
+    EXPECT_EQ(static_cast<const PredicateNode&>(filter).get_predicate_string(), "tbl_a.y < 20");
+    LQP expected;
+    make_query(expected, "tbl_a.y < 20");
+    optimizer.optimize(expected);
+    EXPECT_TRUE(structurally_equal(second_plan.get_root(), expected.get_root()));
+    EXPECT_FALSE(structurally_equal(first_plan.get_root(), second_plan.get_root()));
+
+    // A different predicate structure is a different query.
+    LQP third;
+    make_query(third, "tbl_a.y > 20");
+    LQP third_plan;
+    EXPECT_FALSE(cache.optimize(third, third_plan));
+    EXPECT_EQ(cache.get_entry_count(), 2);
+}
+
+TEST(PlanCache, EvictsLeastRecentlyUsedPlans) {
+    auto optimizer = make_optimizer();
+    // Each query and its plan have 5 nodes, so two entries fit.
+    PlanCache cache(optimizer, 20);
+
+    auto run = [&](const std::string& filter) {
+        LQP query;
+        make_query(query, filter);
+        LQP plan;
+        return cache.optimize(query, plan);
+    };
+    EXPECT_FALSE(run("tbl_a.y < 1"));
+    EXPECT_FALSE(run("tbl_a.y > 1"));
+    EXPECT_TRUE(run("tbl_a.y < 2"));
+    EXPECT_FALSE(run("tbl_a.y = 1"));
+    EXPECT_EQ(cache.get_statistics().evictions, 1);
+    EXPECT_EQ(cache.get_node_count(), 20);
+
+    // The range query was used more recently than the other one, so the latter was evicted.
+    EXPECT_TRUE(run("tbl_a.y < 3"));
+    EXPECT_FALSE(run("tbl_a.y > 3"));
+    EXPECT_EQ(cache.get_statistics().evictions, 2);
+}
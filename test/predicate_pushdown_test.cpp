@@ -0,0 +1,101 @@
+#include "gtest/gtest.h"
+
+#include "predicate_pushdown.hpp"
+
+TEST(PredicatePushdown, ExtractsReferencedTableNames) {
+    ExpressionPool pool;
+    EXPECT_EQ(get_referenced_table_names(parse_expression(pool, "tbl_a.x > 1.5 AND tbl_b.y = 'c.d' OR tbl_a.z < 2")),
+              (std::vector<std::string>{ "tbl_a", "tbl_b" }));
+    EXPECT_TRUE(get_referenced_table_names(parse_expression(pool, "x > 1")).empty());
+}
+
+TEST(PredicatePushdown, PushesPredicatesThroughJoinsAndPredicateChains) {
+    // [Predicate tbl_a]
+    //  \_[Predicate tbl_b]
+    //     \_[Predicate tbl_a, tbl_b]
+    //        \_[Join]
+    //           \_[StoredTable a]
+    //           \_[Join]
+    //              \_[StoredTable b]
+    //              \_[StoredTable c]
+    LQP lqp;
+    const auto& tbl_a = lqp.make_node<StoredTableNode>("tbl_a");
+    const auto& tbl_b = lqp.make_node<StoredTableNode>("tbl_b");
+    const auto& join = lqp.make_node<JoinNode>(tbl_a, lqp.make_node<JoinNode>(tbl_b, lqp.make_node<StoredTableNode>("tbl_c")));
+    const auto& join_predicate = lqp.make_node<PredicateNode>("tbl_a.x = tbl_b.y", join);
+    lqp.set_root(lqp.make_node<PredicateNode>("tbl_a.x > 1", lqp.make_node<PredicateNode>("tbl_b.y < 2", join_predicate)));
+
+    PredicatePushdownRule rule;
+    rule.apply(lqp, 0);
+
+    LQP expected_lqp;
+    expected_lqp.set_root(expected_lqp.make_node<PredicateNode>("tbl_a.x = tbl_b.y", expected_lqp.make_node<JoinNode>(
+            expected_lqp.make_node<PredicateNode>("tbl_a.x > 1", expected_lqp.make_node<StoredTableNode>("tbl_a")),
+            expected_lqp.make_node<JoinNode>(
+                    expected_lqp.make_node<PredicateNode>("tbl_b.y < 2", expected_lqp.make_node<StoredTableNode>("tbl_b")),
+                    expected_lqp.make_node<StoredTableNode>("tbl_c")))));
+    EXPECT_TRUE(structurally_equal(lqp.get_root(), expected_lqp.get_root()));
+    EXPECT_EQ(&lqp.get_root(), &join_predicate);
+
+    // Applying the rule again does not change the plan.
+    auto generation = lqp.get_generation();
+    rule.apply(lqp, 0);
+    EXPECT_EQ(lqp.get_generation(), generation);
+}
+
+TEST(PredicatePushdown, DoesNotEnterSharedSubplans) {
+    LQP lqp;
+    const auto& shared = lqp.make_node<JoinNode>(lqp.make_node<StoredTableNode>("tbl_a"),
+                                                 lqp.make_node<StoredTableNode>("tbl_b"));
+    const auto& predicate = lqp.make_node<PredicateNode>("tbl_a.x > 1", shared);
+    lqp.set_root(lqp.make_node<JoinNode>(predicate, lqp.make_node<PredicateNode>("tbl_b.y > 1", shared)));
+
+    auto generation = lqp.get_generation();
+    PredicatePushdownRule().apply(lqp, 0);
+    EXPECT_EQ(lqp.get_generation(), generation);
+}
+
+TEST(PredicatePushdown, EntersSubplansThatLostParents) {
+    LQP lqp;
+    const auto& tbl_a = lqp.make_node<StoredTableNode>("tbl_a");
+    const auto& shared = lqp.make_node<JoinNode>(tbl_a, lqp.make_node<StoredTableNode>("tbl_b"));
+    const auto& predicate = lqp.make_node<PredicateNode>("tbl_a.x > 1", shared);
+    const auto& other_predicate = lqp.make_node<PredicateNode>("tbl_b.y > 1", shared);
+    lqp.set_root(lqp.make_node<JoinNode>(predicate, other_predicate));
+
+    PredicatePushdownRule rule;
+    auto generation = lqp.get_generation();
+    rule.apply(lqp, 0);
+    ASSERT_EQ(lqp.get_generation(), generation);
+
+    // The predicate itself is unchanged, but can be pushed down once its input is no longer shared.
+    lqp.replace_node(other_predicate, lqp.make_node<StoredTableNode>("tbl_c"));
+    lqp.remove_node(other_predicate);
+    EXPECT_TRUE(lqp.subplan_changed_since(predicate, generation));
+    rule.apply(lqp, generation);
+
+    LQP expected_lqp;
+    expected_lqp.set_root(expected_lqp.make_node<JoinNode>(
+            expected_lqp.make_node<JoinNode>(
+                    expected_lqp.make_node<PredicateNode>("tbl_a.x > 1", expected_lqp.make_node<StoredTableNode>("tbl_a")),
+                    expected_lqp.make_node<StoredTableNode>("tbl_b")),
+            expected_lqp.make_node<StoredTableNode>("tbl_c")));
+    EXPECT_TRUE(structurally_equal(lqp.get_root(), expected_lqp.get_root()));
+    EXPECT_EQ(lqp.get_parent_count(tbl_a), 1);
+}
+
+TEST(PredicatePushdown, PushesIntoPreservedInputsOfOuterJoinsOnly) {
+    LQP lqp;
+    const auto& tbl_a = lqp.make_node<StoredTableNode>("tbl_a");
+    const auto& tbl_b = lqp.make_node<StoredTableNode>("tbl_b");
+    const auto& join = lqp.make_node<JoinNode>(JoinMode::Left, "tbl_a.x = tbl_b.x", tbl_a, tbl_b);
+    lqp.set_root(lqp.make_node<PredicateNode>("is_null(tbl_b.y)", lqp.make_node<PredicateNode>("tbl_a.y > 1", join)));
+    PredicatePushdownRule().apply(lqp, 0);
+
+    LQP expected_lqp;
+    expected_lqp.set_root(expected_lqp.make_node<PredicateNode>("is_null(tbl_b.y)", expected_lqp.make_node<JoinNode>(
+            JoinMode::Left, "tbl_a.x = tbl_b.x",
+            expected_lqp.make_node<PredicateNode>("tbl_a.y > 1", expected_lqp.make_node<StoredTableNode>("tbl_a")),
+            expected_lqp.make_node<StoredTableNode>("tbl_b"))));
+    EXPECT_TRUE(structurally_equal(lqp.get_root(), expected_lqp.get_root()));
+}
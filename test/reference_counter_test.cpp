@@ -27,3 +27,17 @@ TEST(ReferenceCounter, HandlesCopyAndMove) {
     ReferenceCounter c3 = std::move(c1);
     ASSERT_EQ(n, 2);
 }
+
+TEST(ReferenceCounter, TakesNoSpaceWhenDisabled) {
+    struct Ref : utils::BasicReferenceCounter<false> {
+        using utils::BasicReferenceCounter<false>::BasicReferenceCounter;
+        void* ptr = nullptr;
+    };
+    static_assert(std::is_empty_v<utils::BasicReferenceCounter<false>>);
+    static_assert(sizeof(Ref) == sizeof(void*));
+
+    utils::NoReferenceCount count;
+    Ref ref(count);
+    Ref copy = ref;
+    EXPECT_EQ(copy.ptr, nullptr);
+}